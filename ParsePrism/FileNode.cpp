@@ -103,14 +103,6 @@ static inline FileNodeString * __nullable ParseString( const char * & where, siz
     return result;
 }
 
-static inline bool IsSame( double a, double b)
-{
-    if( isnan(a) && isnan(b))
-        return true;
-    
-    return a == b;
-}
-
 
 static inline FileNodeKeyValuePair * __nullable ParseKeyValuePair( const char * & where, size_t & size,  const FileNodeString * key)
 {
@@ -170,7 +162,7 @@ static inline FileNode * __nullable ParseObject( const char * & where, size_t &
                 double value = strtod(where, &end);     // all int32_ts are exactly representable as doubles
                 if( where != end)
                 {
-                    if( IsSame(value, trunc(value)) && value >= double(INT32_MIN) && value <= double(INT32_MAX))
+                    if( IsInt32Value(value))
                         result = new FileNodeInt( int32_t(value));
                     else
                         result = new FileNodeDouble(value);
@@ -220,3 +212,55 @@ FileNode * __nullable FileNode::ParseFile( const char * __nonnull where, size_t
 }
 
 
+
+const FileNode * __nullable FileNodeSet::GetValueForKey( const char * __nonnull key ) const
+{
+    for( const FileNode * node = list; node; node = node->GetNext() )
+    {
+        if( NodeTypeKeyValuePair != node->GetType() )
+            continue;
+
+        const FileNodeKeyValuePair * pair = (const FileNodeKeyValuePair *) node;
+        if( 0 == strcmp( pair->GetKey(), key))
+            return pair->GetValue();
+    }
+
+    return NULL;
+}
+
+static void VisitItems( const FileNode * __nullable node, bool inArray, FileNodeItemVisitor __nonnull visitor, void * __nullable context )
+{
+    if( NULL == node )
+        return;
+
+    switch( node->GetType() )
+    {
+        case NodeTypeKeyValuePair:
+            VisitItems( ((const FileNodeKeyValuePair *) node)->GetValue(), false, visitor, context);
+            break;
+        case NodeTypeSet:
+            if( inArray )
+            {
+                visitor( (const FileNodeSet *) node, context);
+                break;
+            }
+            
+            for( const FileNode * child = ((const FileNodeSet *) node)->GetSet(); child; child = child->GetNext())
+                VisitItems( child, false, visitor, context);
+            break;
+        case NodeTypeArray:
+        {
+            const FileNodeArray & array = *(const FileNodeArray *) node;
+            for( unsigned long i = 0; i < array.GetCount(); i++)
+                VisitItems( array[(int) i], true, visitor, context);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void FileNode::VisitItems( FileNodeItemVisitor __nonnull visitor, void * __nullable context ) const
+{
+    ::VisitItems( this, false, visitor, context);
+}
@@ -33,6 +33,7 @@
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
 /*! @abstract Basic RTTI typing codes for different node types for recognition later */
 typedef enum NodeType : int8_t
@@ -47,6 +48,11 @@ typedef enum NodeType : int8_t
     NodeTypeString
 }NodeType;
 
+class FileNodeSet;
+
+/*! @abstract Callback for FileNode::VisitItems() */
+typedef void (*FileNodeItemVisitor)( const FileNodeSet * __nonnull item, void * __nullable context );
+
 /*! @abstract Base class for tree of data objects from deserialized file */
 class FileNode
 {
@@ -79,6 +85,11 @@ public:
     
     /*! @abstract  Read in a file from disk and create a tree of nodes */
     static FileNode * __nullable ParseFile( const char * __nonnull where, size_t size );
+    
+    /*! @abstract  Call visitor for each item in the tree
+     *  @discussion An item is a set which is an element of an array, such as a single magic item in the database.
+     *              Sets nested inside an item are part of that item and are not visited separately. */
+    void VisitItems( FileNodeItemVisitor __nonnull visitor, void * __nullable context ) const;
 };
 
 static inline void Indent( int depth)
@@ -87,6 +98,21 @@ static inline void Indent( int depth)
         putc( '\t', stdout);
 }
 
+static inline bool IsSame( double a, double b)
+{
+    if( isnan(a) && isnan(b))
+        return true;
+    
+    return a == b;
+}
+
+/*! @abstract True if a number in the file should become a FileNodeInt rather than a FileNodeDouble
+ *  @discussion Shared by every parser so they agree on how numbers are typed. */
+static inline bool IsInt32Value( double value)
+{
+    return IsSame(value, trunc(value)) && value >= double(INT32_MIN) && value <= double(INT32_MAX);
+}
+
 /*! @abstract Implements a node which is a set of other nodes */
 class FileNodeSet : public FileNode
 {
@@ -132,6 +158,9 @@ public:
     
     inline const FileNode * __nullable GetSet() const { return list; }
     
+    /*! @abstract Find the value of the first key-value pair in the set with the given key */
+    const FileNode * __nullable GetValueForKey( const char * __nonnull key ) const;
+    
     virtual void Print(int indentDepth) const
     {
         if( NULL == list)
@@ -315,10 +344,17 @@ public:
     inline double GetValue() const { return value; }
     virtual void Print(int indentDepth) const {  printf( "%f", value); }
     virtual void write( FILE * __nonnull file ) const
+    {
+        char string[30];
+        GetText( string);
+        fprintf( file, "%s", string );
+    }
+    
+    /*! @abstract The value as write() puts it in the file */
+    void GetText( char string[__nonnull 30] ) const
     {
         // workaround for bug in MacOS wherein 0.500000 is not trimmed to 0.5
         // for %g format, which I would therwise like to use here
-        char string[30];
         int len = snprintf( string, 30, "%g", value);
 
         bool hasDecimal = false;
@@ -337,8 +373,6 @@ public:
                 
                 string[last] = '\0';
             }
-        
-        fprintf( file, "%s", string );
     }
 };
 
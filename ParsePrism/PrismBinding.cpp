@@ -0,0 +1,324 @@
+//
+//  PrismBinding.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismBinding.h"
+#include "FileNode.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+template <typename T>  T min( T a, T b){ return a < b ? a : b;}
+
+// A scanner over the same grammar as ParseObject() in FileNode.cpp, which makes no nodes
+typedef struct BindState
+{
+    const PrismField * __nonnull    fields;
+    size_t                          fieldCount;
+    PrismRecordAppender __nonnull   append;
+    void * __nonnull                output;
+    unsigned                        recordDepth;    // non-zero while inside an item. Sets in arrays there are not records.
+}BindState;
+
+typedef enum ScalarType
+{
+    ScalarTypeNone = 0,         // a set, array or key-value pair
+    ScalarTypeBoolean,
+    ScalarTypeInteger,
+    ScalarTypeDouble,
+    ScalarTypeString
+}ScalarType;
+
+typedef struct Scalar
+{
+    ScalarType      type;
+    bool            boolean;
+    double          number;
+    PrismStringRef  string;
+}Scalar;
+
+static bool ScanObject( const char * __nonnull & where, size_t & size, bool isElement, BindState & state, Scalar * __nullable scalar );
+
+// Advance past a string. On return string holds its contents, without the quotes.
+static bool ScanString( const char * __nonnull & where, size_t & size, PrismStringRef & string, uint32_t * __nullable hash )
+{
+    if( size < 2 || where[0] != '"')
+        return false;
+    
+    uint32_t h = 0x811c9dc5U;
+    const char * p = &where[1];
+    char last = '\0';
+    size_t len;
+    for( len = 0; len < size - 2; len++)
+    {
+        if( p[len] == '"' && last != '\\' )
+            break;
+        last = p[len];
+        h = (h ^ uint8_t(last)) * 0x01000193U;
+    }
+    
+    if( '"' != p[len])
+        return false;
+    
+    string.string = p;
+    string.length = len;
+    if( hash )
+        *hash = h;
+    
+    where += len + 2;
+    size -= len + 2;
+    return true;
+}
+
+// Members of a set or elements of an array, up to but not including the close character
+static bool ScanList( const char * __nonnull & where, size_t & size, bool isArray, BindState & state )
+{
+    if( 0 == size || where[0] == (isArray ? ']' : '}') )
+        return true;
+    
+    while(1)
+    {
+        if( ! ScanObject( where, size, isArray, state, NULL) )
+            return false;
+        
+        if( 0 == size || where[0] != ',')
+            return true;
+        
+        where++;
+        size--;
+    }
+}
+
+static inline const PrismField * __nullable FindField( const BindState & state, uint32_t hash, const PrismStringRef & key )
+{
+    for( size_t i = 0; i < state.fieldCount; i++)
+    {
+        const PrismField & field = state.fields[i];
+        if( field.hash == hash && field.keyLength == key.length && 0 == memcmp( field.key, key.string, key.length) )
+            return &field;
+    }
+    
+    return NULL;
+}
+
+static void Store( const PrismField & field, const Scalar & value, void * __nonnull record )
+{
+    char * member = (char *) record + field.offset;
+    switch( field.type )
+    {
+        case PrismFieldTypeBoolean:
+            if( ScalarTypeBoolean == value.type )
+                *(bool *) member = value.boolean;
+            break;
+        case PrismFieldTypeInteger:
+            if( ScalarTypeInteger == value.type )
+                *(int32_t *) member = int32_t( value.number);
+            break;
+        case PrismFieldTypeDouble:
+            if( ScalarTypeInteger == value.type || ScalarTypeDouble == value.type )
+                *(double *) member = value.number;
+            break;
+        case PrismFieldTypeString:
+            if( ScalarTypeString == value.type )
+                *(PrismStringRef *) member = value.string;
+            break;
+    }
+}
+
+// The body of an item, after the '{'
+static bool ScanRecordMembers( const char * __nonnull & where, size_t & size, BindState & state, void * __nonnull record )
+{
+    // Like FileNodeSet::GetValueForKey(), the first of a repeated key wins. (Past 64 fields, the last one does.)
+    uint64_t stored = 0;
+    
+    if( 0 == size || where[0] == '}' )
+        return true;
+    
+    while(1)
+    {
+        if( 0 == size )
+            return false;
+        
+        if( '"' == where[0] )
+        {
+            PrismStringRef key;
+            uint32_t hash;
+            if( ! ScanString( where, size, key, &hash) )
+                return false;
+            
+            if( size && ':' == where[0] )
+            {
+                where++;
+                size--;
+                
+                const PrismField * field = FindField( state, hash, key);
+                Scalar value = { ScalarTypeNone, false, 0, { NULL, 0 } };
+                if( size >= 2 && ! ScanObject( where, size, false, state, field ? &value : NULL) )
+                    return false;
+                
+                size_t fieldIndex = field ? field - state.fields : 0;
+                uint64_t bit = fieldIndex < 64 ? 1ULL << fieldIndex : 0;
+                if( field && ! (stored & bit) )
+                {
+                    Store( *field, value, record);
+                    stored |= bit;
+                }
+            }
+        }
+        else if( ! ScanObject( where, size, false, state, NULL) )
+            return false;
+        
+        if( 0 == size || where[0] != ',')
+            return true;
+        
+        where++;
+        size--;
+    }
+}
+
+static bool ScanRecord( const char * __nonnull & where, size_t & size, BindState & state )
+{
+    void * record = state.append( state.output);
+    if( NULL == record )
+        return false;
+    
+    state.recordDepth++;
+    bool result = ScanRecordMembers( where, size, state, record);
+    state.recordDepth--;
+    return result;
+}
+
+static bool ScanObject( const char * __nonnull & where, size_t & size, bool isElement, BindState & state, Scalar * __nullable scalar )
+{
+    if( 0 == size )
+        return false;
+    
+    char closeChar = '\0';
+    char next = where[0];
+    switch(next)
+    {
+        case '{':   // set
+            where++; size--;
+            if( ! (isElement && 0 == state.recordDepth ? ScanRecord( where, size, state) : ScanList( where, size, false, state)) )
+                return false;
+            closeChar = '}';
+            break;
+        case '[':   // array
+            where++; size--;
+            if( ! ScanList( where, size, true, state) )
+                return false;
+            closeChar = ']';
+            break;
+        case '"':
+        {
+            PrismStringRef string;
+            if( ! ScanString( where, size, string, NULL) )
+                return false;
+            
+            if( 0 == size || where[0] != ':')
+            {
+                if( scalar )
+                {
+                    scalar->type = ScalarTypeString;
+                    scalar->string = string;
+                }
+                break;
+            }
+            
+            // key value pair, which may hold records
+            where++;
+            size--;
+            if( size >= 2 && ! ScanObject( where, size, false, state, NULL) )
+                return false;
+            break;
+        }
+        default:
+            // A constant of some kind
+            if( next == '.' || next == '-' || (next >= '0' && next <= '9') )
+            {
+                char * end = const_cast<char*>(where);
+                double value = strtod(where, &end);
+                if( where == end )
+                    return false;
+                
+                if( scalar )
+                {
+                    scalar->number = value;
+                    scalar->type = IsInt32Value(value) ?
+                                    ScalarTypeInteger : ScalarTypeDouble;
+                }
+                
+                size_t len = min(size_t(end - where), size);
+                size -= len;
+                where += len;
+            }
+            else if( 0 == strncasecmp( where, "false", min( size, 5UL)))
+            {
+                if( scalar )
+                {
+                    scalar->type = ScalarTypeBoolean;
+                    scalar->boolean = false;
+                }
+                size_t len = min(size, 5UL);
+                where += len;
+                size -= len;
+            }
+            else if( 0 == strncasecmp( where, "true", min( size, 4UL)))
+            {
+                if( scalar )
+                {
+                    scalar->type = ScalarTypeBoolean;
+                    scalar->boolean = true;
+                }
+                size_t len = min(size, 4UL);
+                where += len;
+                size -= len;
+            }
+            else
+                return false;
+            break;
+    }
+    
+    if( '\0' != closeChar)
+    {
+        if( size == 0 || *where != closeChar)
+            return false;
+        
+        where++;
+        size--;
+    }
+    
+    return true;
+}
+
+bool PrismBindRecordsRaw( const char * __nonnull where, size_t size, const PrismField * __nonnull fields, size_t fieldCount,
+                          PrismRecordAppender __nonnull append, void * __nonnull output )
+{
+    BindState state = { fields, fieldCount, append, output, 0 };
+    return ScanObject( where, size, false, state, NULL);
+}
@@ -0,0 +1,119 @@
+//
+//  PrismBinding.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismBinding_h
+#define PrismBinding_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <type_traits>
+
+/*! @abstract FNV-1a hash of a key, usable at compile time */
+static constexpr uint32_t PrismKeyHash( const char * __nonnull key, size_t length )
+{
+    uint32_t hash = 0x811c9dc5U;
+    for( size_t i = 0; i < length; i++ )
+        hash = (hash ^ uint8_t(key[i])) * 0x01000193U;
+    return hash;
+}
+
+/*! @abstract A string in the input data. Not NUL terminated. Only valid while the input is. */
+typedef struct PrismStringRef
+{
+    const char * __nullable string;
+    size_t                  length;
+}PrismStringRef;
+
+/*! @abstract The C++ types a record field may have */
+typedef enum PrismFieldType : int8_t
+{
+    PrismFieldTypeBoolean = 0,      // bool
+    PrismFieldTypeInteger,          // int32_t
+    PrismFieldTypeDouble,           // double. Integers in the data are converted.
+    PrismFieldTypeString            // PrismStringRef
+}PrismFieldType;
+
+template <typename T> struct PrismFieldTypeOf;
+template <> struct PrismFieldTypeOf<bool>           { static constexpr PrismFieldType value = PrismFieldTypeBoolean; };
+template <> struct PrismFieldTypeOf<int32_t>        { static constexpr PrismFieldType value = PrismFieldTypeInteger; };
+template <> struct PrismFieldTypeOf<double>         { static constexpr PrismFieldType value = PrismFieldTypeDouble; };
+template <> struct PrismFieldTypeOf<PrismStringRef> { static constexpr PrismFieldType value = PrismFieldTypeString; };
+
+/*! @abstract Maps a key in the data to a member of a record */
+typedef struct PrismField
+{
+    uint32_t                hash;       // PrismKeyHash( key )
+    uint32_t                keyLength;
+    const char * __nonnull  key;
+    PrismFieldType          type;
+    size_t                  offset;     // of the member in the record
+}PrismField;
+
+/*! @abstract Declare a PrismField for record.member, found under key in the data
+ *  @discussion e.g.
+ *
+ *      typedef struct Item { PrismStringRef name; PrismStringRef rarity; double value; } Item;
+ *      static constexpr PrismField kItemFields[] = { PRISM_FIELD( Item, name, "name" ), PRISM_FIELD( Item, rarity, "rarity" ),
+ *                                                    PRISM_FIELD( Item, value, "value" ) };
+ *
+ *  The key hash is computed by the compiler. PrismSchema::PrintBinding() will write these for you. */
+#define PRISM_FIELD( record, member, key )                                                                      \
+    PrismField{ PrismKeyHash( key, sizeof(key) - 1), uint32_t(sizeof(key) - 1), key,                           \
+                PrismFieldTypeOf<decltype(record::member)>::value, offsetof( record, member) }
+
+/*! @abstract Callback which adds a default initialized record to the output and returns a pointer to it */
+typedef void * __nullable (*PrismRecordAppender)( void * __nonnull output );
+
+/*! @abstract Untyped engine behind PrismBindRecords() */
+bool PrismBindRecordsRaw( const char * __nonnull where, size_t size, const PrismField * __nonnull fields, size_t fieldCount,
+                          PrismRecordAppender __nonnull append, void * __nonnull output );
+
+/*! @abstract Fill an array of records straight from .prism file data, without building a tree of FileNodes
+ *  @discussion Each item (a set which is an element of an array, as in FileNode::VisitItems) becomes one record. Keys directly inside
+ *              the item are matched against fields by hash, then by comparing the key, and the value is converted in place.
+ *              Keys with no field, and values of the wrong type, are skipped, leaving the member value initialized.
+ *              Strings are not copied. They point into where, which must outlive the records.
+ *  @return     false if the data is malformed. Records found before the problem are kept. */
+template <typename Record, size_t FieldCount>
+static inline bool PrismBindRecords( const char * __nonnull where, size_t size, const PrismField (&fields)[FieldCount], std::vector<Record> & records )
+{
+    static_assert( std::is_standard_layout<Record>::value, "records are filled in by member offset" );
+    
+    PrismRecordAppender append = []( void * output ) -> void *
+    {
+        std::vector<Record> & list = *(std::vector<Record> *) output;
+        list.emplace_back();
+        return &list.back();
+    };
+    
+    return PrismBindRecordsRaw( where, size, fields, FieldCount, append, &records );
+}
+
+#endif /* PrismBinding_h */
@@ -0,0 +1,230 @@
+//
+//  PrismClient.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismClient.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+bool PrismClient::Connect( const char * __nonnull socketPath )
+{
+    Disconnect();
+    
+    struct sockaddr_un address;
+    memset( &address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if( strlen( socketPath) >= sizeof(address.sun_path) )
+        return false;
+    strncpy( address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    
+    fd = socket( AF_UNIX, SOCK_STREAM, 0);
+    if( fd < 0 )
+        return false;
+    
+    if( connect( fd, (struct sockaddr *) &address, sizeof(address)) )
+    {
+        Disconnect();
+        return false;
+    }
+    
+    return true;
+}
+
+void PrismClient::Disconnect()
+{
+    if( fd >= 0 )
+        close( fd);
+    fd = -1;
+}
+
+bool PrismClient::Request( PrismOp op, uint8_t database, uint16_t count, const std::string & payload, PrismStatus * __nonnull status, std::string & response )
+{
+    if( fd < 0 || payload.size() > kPrismMaxRequestLength )
+        return false;
+    
+    // header and payload in one write, so they travel together
+    std::string request( sizeof(PrismRequestHeader), '\0');
+    PrismRequestHeader * header = (PrismRequestHeader *) &request[0];
+    header->length = uint32_t( payload.size());
+    header->op = op;
+    header->database = database;
+    header->count = count;
+    request += payload;
+    
+    PrismResponseHeader responseHeader;
+    if( ! PrismWriteFully( fd, request.data(), request.size()) || ! PrismReadFully( fd, &responseHeader, sizeof(responseHeader)) )
+        return false;
+    
+    response.resize( responseHeader.length);
+    if( responseHeader.length && ! PrismReadFully( fd, &response[0], responseHeader.length) )
+        return false;
+    
+    *status = PrismStatus( responseHeader.status);
+    return true;
+}
+
+typedef struct ConnectionResult
+{
+    std::vector<double>     latencies;      // seconds
+    unsigned long           errors;
+    unsigned long           notFound;
+}ConnectionResult;
+
+static double Percentile( const std::vector<double> & sorted, double fraction )
+{
+    if( sorted.empty() )
+        return 0;
+    
+    size_t index = size_t( fraction * double( sorted.size() - 1) + 0.5);
+    return sorted[ std::min( index, sorted.size() - 1) ];
+}
+
+int PrismLoadGeneratorMain( int argc, const char * __nonnull argv[__nonnull] )
+{
+    // -bench socket [-c connections] [-n requests] [-d database] [-count items] op [argument]...
+    if( argc < 4 )
+    {
+        fprintf( stderr, "usage: %s -bench socket [-c connections] [-n requests] [-d database] [-count items] lookup|filter|draw [argument]...\n", argv[0]);
+        return -1;
+    }
+    
+    const char * socketPath = argv[2];
+    unsigned connections = 4;
+    unsigned long requests = 10000;         // per connection
+    uint8_t database = 0;
+    uint16_t count = 1;
+    
+    int i = 3;
+    for( ; i + 1 < argc && argv[i][0] == '-'; i += 2 )
+    {
+        if( 0 == strcmp( argv[i], "-c") )
+            connections = (unsigned) atoi( argv[i+1]);
+        else if( 0 == strcmp( argv[i], "-n") )
+            requests = strtoul( argv[i+1], NULL, 10);
+        else if( 0 == strcmp( argv[i], "-d") )
+            database = (uint8_t) atoi( argv[i+1]);
+        else if( 0 == strcmp( argv[i], "-count") )
+            count = (uint16_t) atoi( argv[i+1]);
+        else
+            break;
+    }
+    
+    if( i >= argc || 0 == connections )
+        return -1;
+    
+    PrismOp op;
+    if( 0 == strcmp( argv[i], "lookup") )
+        op = PrismOpLookup;
+    else if( 0 == strcmp( argv[i], "filter") )
+        op = PrismOpFilter;
+    else if( 0 == strcmp( argv[i], "draw") )
+        op = PrismOpDraw;
+    else
+    {
+        fprintf( stderr, "Unknown op \"%s\"\n", argv[i]);
+        return -1;
+    }
+    
+    // The server may hang up on us mid-run. Count it as a connection error rather than dying of SIGPIPE.
+    signal( SIGPIPE, SIG_IGN);
+    
+    std::string payload;
+    for( i++; i < argc; i++ )
+    {
+        payload += argv[i];
+        payload += '\0';
+    }
+    
+    // Connect everyone before starting the clock
+    std::vector<PrismClient> clients( connections);
+    for( PrismClient & client : clients )
+        if( ! client.Connect( socketPath) )
+        {
+            fprintf( stderr, "Connect to \"%s\" failed\n", socketPath);
+            return -1;
+        }
+    
+    std::vector<ConnectionResult> results( connections);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for( unsigned c = 0; c < connections; c++ )
+        threads.emplace_back( [&, c]
+        {
+            ConnectionResult & result = results[c];
+            result.latencies.reserve( requests);
+            result.errors = result.notFound = 0;
+            std::string response;
+            for( unsigned long r = 0; r < requests; r++ )
+            {
+                PrismStatus status;
+                auto before = std::chrono::steady_clock::now();
+                bool ok = clients[c].Request( op, database, count, payload, &status, response);
+                auto after = std::chrono::steady_clock::now();
+                if( ! ok )
+                {
+                    result.errors++;
+                    break;
+                }
+                
+                result.notFound += PrismStatusOK != status;
+                result.latencies.push_back( std::chrono::duration<double>( after - before).count());
+            }
+        });
+    
+    for( std::thread & t : threads )
+        t.join();
+    double elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start).count();
+    
+    std::vector<double> latencies;
+    unsigned long errors = 0, notFound = 0;
+    for( ConnectionResult & result : results )
+    {
+        latencies.insert( latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+        notFound += result.notFound;
+    }
+    std::sort( latencies.begin(), latencies.end());
+    
+    printf( "%lu requests on %u connections in %.3f s: %.0f requests/s\n", (unsigned long) latencies.size(), connections, elapsed,
+            elapsed > 0 ? double( latencies.size()) / elapsed : 0.0);
+    printf( "latency (us): p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n",
+            Percentile( latencies, 0.50) * 1e6, Percentile( latencies, 0.90) * 1e6, Percentile( latencies, 0.99) * 1e6,
+            latencies.size() ? latencies.back() * 1e6 : 0.0);
+    if( notFound || errors )
+        printf( "%lu not found / bad request, %lu connection errors\n", notFound, errors);
+    
+    return errors ? -1 : 0;
+}
@@ -0,0 +1,61 @@
+//
+//  PrismClient.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismClient_h
+#define PrismClient_h
+
+#include "PrismServer.h"
+#include <string>
+
+/*! @abstract One connection to a PrismServer
+ *  @discussion Not thread safe. Use one per thread. */
+class PrismClient
+{
+private:
+    int     fd;
+
+public:
+    PrismClient() : fd(-1){}
+    ~PrismClient(){ Disconnect(); }
+    
+    bool Connect( const char * __nonnull socketPath );
+    void Disconnect();
+    
+    /*! @abstract Send a request and wait for the response
+     *  @param payload  '\0' separated arguments, see PrismOp
+     *  @return     false if the connection failed. Otherwise status and response hold the answer. */
+    bool Request( PrismOp op, uint8_t database, uint16_t count, const std::string & payload, PrismStatus * __nonnull status, std::string & response );
+};
+
+/*! @abstract  ParsePrism -bench socket [-c connections] [-n requests] [-d database] [-count items] op [argument]...
+ *  @discussion Load generator. Each connection runs on its own thread and sends requests back to back. op is lookup, filter or
+ *              draw and the arguments form its payload. Prints throughput and latency percentiles. */
+int PrismLoadGeneratorMain( int argc, const char * __nonnull argv[__nonnull] );
+
+#endif /* PrismClient_h */
@@ -0,0 +1,585 @@
+//
+//  PrismIndex.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismIndex.h"
+#include "PrismThreads.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <sys/stat.h>
+
+// Bump if the file layout changes
+static const uint32_t kIndexMagic = 0x58495250;     // "PRIX"
+static const uint32_t kIndexVersion = 1;
+
+static inline uint8_t Lower( uint8_t c ){ return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+
+// Words are runs of letters and digits. Bytes >= 0x80 count as letters so UTF-8 stays in one piece.
+static inline bool IsWordByte( uint8_t c ){ return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80; }
+
+static inline uint32_t TrigramKey( const uint8_t * __nonnull p )
+{
+    return (uint32_t(Lower(p[0])) << 16) | (uint32_t(Lower(p[1])) << 8) | Lower(p[2]);
+}
+
+// FNV-1a over the lower case word, folded to 32 bits. Collisions are weeded out when the text is checked.
+static inline uint32_t WordKey( const uint8_t * __nonnull p, size_t length )
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for( size_t i = 0; i < length; i++)
+        hash = (hash ^ Lower(p[i])) * 0x100000001b3ULL;
+    return uint32_t(hash ^ (hash >> 32));
+}
+
+static inline uint64_t Fingerprint( uint64_t hash, const void * __nonnull bytes, size_t length )
+{
+    const uint8_t * p = (const uint8_t *) bytes;
+    for( size_t i = 0; i < length; i++)
+        hash = (hash ^ p[i]) * 0x100000001b3ULL;
+    return hash;
+}
+
+// Case insensitive search for a needle which is already lower case
+static bool ContainsLowercase( const char * __nonnull haystack, size_t haystackLength, const char * __nonnull needle, size_t needleLength )
+{
+    if( needleLength > haystackLength )
+        return false;
+    
+    for( size_t i = 0; i + needleLength <= haystackLength; i++)
+    {
+        size_t j = 0;
+        while( j < needleLength && Lower(haystack[i+j]) == (uint8_t) needle[j] )
+            j++;
+        if( j == needleLength )
+            return true;
+    }
+    
+    return false;
+}
+
+// Case insensitive search for a whole word which is already lower case
+static bool ContainsWord( const char * __nonnull text, size_t length, const char * __nonnull word, size_t wordLength )
+{
+    const uint8_t * p = (const uint8_t *) text;
+    size_t i = 0;
+    while( i < length )
+    {
+        while( i < length && ! IsWordByte(p[i]) )
+            i++;
+        size_t start = i;
+        while( i < length && IsWordByte(p[i]) )
+            i++;
+        
+        if( i - start != wordLength )
+            continue;
+        
+        size_t j = 0;
+        while( j < wordLength && Lower(p[start + j]) == (uint8_t) word[j] )
+            j++;
+        if( j == wordLength )
+            return true;
+    }
+    
+    return false;
+}
+
+struct PrismIndex::CollectContext
+{
+    std::vector<Document> * __nonnull               documents;
+    std::vector<std::string> * __nonnull            paths;
+    std::unordered_map<std::string, uint32_t>       pathIndex;
+    std::string                                     path;
+    const FileNodeSet * __nullable                  item;
+};
+
+void PrismIndex::CollectStrings( const FileNode * __nullable node, CollectContext & c )
+{
+    if( NULL == node )
+        return;
+    
+    switch( node->GetType() )
+    {
+        case NodeTypeKeyValuePair:
+        {
+            const FileNodeKeyValuePair * pair = (const FileNodeKeyValuePair *) node;
+            size_t oldLength = c.path.size();
+            if( oldLength )
+                c.path += '/';
+            c.path += pair->GetKey();
+            CollectStrings( pair->GetValue(), c);
+            c.path.resize( oldLength);
+            break;
+        }
+        case NodeTypeSet:
+            for( const FileNode * child = ((const FileNodeSet *) node)->GetSet(); child; child = child->GetNext())
+                CollectStrings( child, c);
+            break;
+        case NodeTypeArray:
+        {
+            const FileNodeArray & array = *(const FileNodeArray *) node;
+            for( unsigned long i = 0; i < array.GetCount(); i++)
+                CollectStrings( array[(int) i], c);
+            break;
+        }
+        case NodeTypeString:
+        {
+            auto found = c.pathIndex.find( c.path);
+            uint32_t pathIndex;
+            if( found == c.pathIndex.end() )
+            {
+                pathIndex = uint32_t( c.paths->size());
+                c.paths->push_back( c.path);
+                c.pathIndex.emplace( c.path, pathIndex);
+            }
+            else
+                pathIndex = found->second;
+            
+            const char * text = ((const FileNodeString *) node)->GetString();
+            c.documents->push_back( { c.item, text, uint32_t(strlen(text)), pathIndex } );
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void PrismIndex::CollectItem( const FileNodeSet * __nonnull item, void * __nullable context )
+{
+    CollectContext & c = *(CollectContext *) context;
+    c.item = item;
+    c.path.clear();
+    CollectStrings( item, c);
+}
+
+void PrismIndex::CollectDocuments( const FileNode * __nonnull root )
+{
+    documents.clear();
+    paths.clear();
+    
+    CollectContext context;
+    context.documents = &documents;
+    context.paths = &paths;
+    context.item = NULL;
+    root->VisitItems( CollectItem, &context);
+    
+    fingerprint = 0xcbf29ce484222325ULL;
+    for( const Document & d : documents )
+    {
+        fingerprint = Fingerprint( fingerprint, d.text, d.length + 1);
+        fingerprint = Fingerprint( fingerprint, paths[d.path].c_str(), paths[d.path].size() + 1);
+    }
+}
+
+// Stable LSD radix sort of (key << 32 | doc) pairs on the low keyBits bits of the key
+static void RadixSortByKey( std::vector<uint64_t> & pairs, unsigned keyBits )
+{
+    const unsigned kDigitBits = 12;
+    std::vector<uint64_t> scratch( pairs.size());
+    std::vector<size_t> counts( 1U << kDigitBits);
+    for( unsigned shift = 32; shift < 32 + keyBits; shift += kDigitBits )
+    {
+        std::fill( counts.begin(), counts.end(), 0);
+        for( uint64_t pair : pairs )
+            counts[ (pair >> shift) & ((1U << kDigitBits) - 1) ]++;
+        
+        size_t offset = 0;
+        for( size_t & count : counts )
+        {
+            size_t n = count;
+            count = offset;
+            offset += n;
+        }
+        
+        for( uint64_t pair : pairs )
+            scratch[ counts[ (pair >> shift) & ((1U << kDigitBits) - 1) ]++ ] = pair;
+        pairs.swap( scratch);
+    }
+}
+
+void PrismIndex::BuildTable( const std::vector<Document> & documents, bool byWord, unsigned threadCount, PostingTable & table )
+{
+    if( 0 == threadCount )
+        threadCount = DefaultThreadCount();
+    
+    // Each thread makes a sorted list of (key, doc) pairs for a contiguous range of documents
+    std::vector< std::vector<uint64_t> > parts( threadCount);
+    ParallelFor( documents.size(), threadCount, [&]( unsigned long begin, unsigned long end, unsigned index )
+    {
+        std::vector<uint64_t> & pairs = parts[index];
+        if( ! byWord )
+        {
+            size_t total = 0;
+            for( unsigned long doc = begin; doc < end; doc++)
+                total += documents[doc].length;
+            pairs.reserve( total);
+        }
+        
+        for( unsigned long doc = begin; doc < end; doc++)
+        {
+            const uint8_t * p = (const uint8_t *) documents[doc].text;
+            size_t length = documents[doc].length;
+            if( byWord )
+            {
+                size_t i = 0;
+                while( i < length )
+                {
+                    while( i < length && ! IsWordByte(p[i]) )
+                        i++;
+                    size_t start = i;
+                    while( i < length && IsWordByte(p[i]) )
+                        i++;
+                    if( i > start )
+                        pairs.push_back( (uint64_t( WordKey( p + start, i - start)) << 32) | doc );
+                }
+            }
+            else
+                for( size_t i = 0; i + 3 <= length; i++)
+                    pairs.push_back( (uint64_t( TrigramKey( p + i)) << 32) | doc );
+        }
+        
+        // Pairs are already in document order, so a stable sort by key leaves them fully sorted.
+        // Repeats of a key within a document end up next to each other.
+        RadixSortByKey( pairs, byWord ? 32 : 24);
+        pairs.erase( std::unique( pairs.begin(), pairs.end()), pairs.end());
+    });
+    
+    // Concatenate, then merge neighboring runs in parallel until there is only one
+    std::vector<uint64_t> all;
+    std::vector<size_t> runs( 1, 0);
+    size_t total = 0;
+    for( const std::vector<uint64_t> & part : parts )
+        total += part.size();
+    all.reserve( total);
+    for( std::vector<uint64_t> & part : parts )
+    {
+        all.insert( all.end(), part.begin(), part.end());
+        runs.push_back( all.size());
+        std::vector<uint64_t>().swap( part);
+    }
+    
+    while( runs.size() > 2 )
+    {
+        unsigned long pairCount = (runs.size() - 1) / 2;
+        ParallelFor( pairCount, threadCount, [&]( unsigned long begin, unsigned long end, unsigned )
+        {
+            for( unsigned long i = begin; i < end; i++)
+                std::inplace_merge( all.begin() + runs[2*i], all.begin() + runs[2*i+1], all.begin() + runs[2*i+2]);
+        });
+        
+        std::vector<size_t> merged;
+        for( size_t i = 0; i < runs.size(); i += 2)
+            merged.push_back( runs[i]);
+        if( merged.back() != runs.back() )
+            merged.push_back( runs.back());
+        runs.swap( merged);
+    }
+    
+    // Compress into sorted keys and offsets into the posting lists
+    table.keys.clear();
+    table.offsets.clear();
+    table.docs.resize( all.size());
+    for( size_t i = 0; i < all.size(); i++)
+    {
+        uint32_t key = uint32_t( all[i] >> 32);
+        if( table.keys.empty() || table.keys.back() != key )
+        {
+            table.keys.push_back( key);
+            table.offsets.push_back( uint32_t(i));
+        }
+        table.docs[i] = uint32_t( all[i]);
+    }
+    table.offsets.push_back( uint32_t( all.size()));
+}
+
+void PrismIndex::Build( const FileNode * __nonnull root, unsigned threadCount )
+{
+    CollectDocuments( root);
+    BuildTable( documents, false, threadCount, trigrams);
+    BuildTable( documents, true, threadCount, words);
+}
+
+bool PrismIndex::Lookup( const PostingTable & table, uint32_t key, const uint32_t * __nullable * __nonnull begin, const uint32_t * __nullable * __nonnull end )
+{
+    auto found = std::lower_bound( table.keys.begin(), table.keys.end(), key);
+    if( found == table.keys.end() || *found != key )
+        return false;
+    
+    size_t i = found - table.keys.begin();
+    *begin = table.docs.data() + table.offsets[i];
+    *end = table.docs.data() + table.offsets[i+1];
+    return true;
+}
+
+// Intersect the posting lists for a set of keys, shortest list first
+static std::vector<uint32_t> Intersect( std::vector< std::pair<const uint32_t *, const uint32_t *> > & lists )
+{
+    std::sort( lists.begin(), lists.end(), []( const auto & a, const auto & b ){ return (a.second - a.first) < (b.second - b.first); });
+    
+    std::vector<uint32_t> result( lists[0].first, lists[0].second);
+    std::vector<uint32_t> scratch;
+    for( size_t i = 1; i < lists.size() && result.size(); i++)
+    {
+        scratch.clear();
+        std::set_intersection( result.begin(), result.end(), lists[i].first, lists[i].second, std::back_inserter(scratch));
+        result.swap( scratch);
+    }
+    
+    return result;
+}
+
+std::vector<uint32_t> PrismIndex::FindSubstring( const char * __nonnull text ) const
+{
+    std::string needle( text);
+    for( char & c : needle )
+        c = (char) Lower( (uint8_t) c);
+    
+    std::vector<uint32_t> result;
+    if( needle.size() < 3 )
+    {
+        // too short for a trigram. Look at everything.
+        for( uint32_t doc = 0; doc < documents.size(); doc++)
+            if( ContainsLowercase( documents[doc].text, documents[doc].length, needle.c_str(), needle.size()) )
+                result.push_back( doc);
+        return result;
+    }
+    
+    std::vector< std::pair<const uint32_t *, const uint32_t *> > lists;
+    for( size_t i = 0; i + 3 <= needle.size(); i++)
+    {
+        const uint32_t * begin, * end;
+        if( ! Lookup( trigrams, TrigramKey( (const uint8_t *) needle.c_str() + i), &begin, &end) )
+            return result;
+        lists.push_back( std::make_pair( begin, end));
+    }
+    
+    for( uint32_t doc : Intersect( lists) )
+        if( ContainsLowercase( documents[doc].text, documents[doc].length, needle.c_str(), needle.size()) )
+            result.push_back( doc);
+    
+    return result;
+}
+
+std::vector<uint32_t> PrismIndex::FindWords( const char * __nonnull text ) const
+{
+    std::vector<std::string> queryWords;
+    std::vector< std::pair<const uint32_t *, const uint32_t *> > lists;
+    std::vector<uint32_t> result;
+    
+    const uint8_t * p = (const uint8_t *) text;
+    size_t length = strlen( text);
+    size_t i = 0;
+    while( i < length )
+    {
+        while( i < length && ! IsWordByte(p[i]) )
+            i++;
+        size_t start = i;
+        while( i < length && IsWordByte(p[i]) )
+            i++;
+        if( i == start )
+            continue;
+        
+        const uint32_t * begin, * end;
+        if( ! Lookup( words, WordKey( p + start, i - start), &begin, &end) )
+            return result;
+        lists.push_back( std::make_pair( begin, end));
+        
+        std::string word( text + start, i - start);
+        for( char & c : word )
+            c = (char) Lower( (uint8_t) c);
+        queryWords.push_back( word);
+    }
+    
+    if( lists.empty() )
+        return result;
+    
+    for( uint32_t doc : Intersect( lists) )
+    {
+        bool all = true;
+        for( const std::string & word : queryWords )
+            if( ! ContainsWord( documents[doc].text, documents[doc].length, word.c_str(), word.size()) )
+            {
+                all = false;
+                break;
+            }
+        
+        if( all )
+            result.push_back( doc);
+    }
+    
+    return result;
+}
+
+std::vector<const FileNodeSet *> PrismIndex::GetItems( const std::vector<uint32_t> & docs ) const
+{
+    std::vector<const FileNodeSet *> result;
+    std::unordered_set<const FileNodeSet *> seen;
+    for( uint32_t doc : docs )
+        if( seen.insert( GetItem(doc)).second )
+            result.push_back( GetItem(doc));
+    
+    return result;
+}
+
+// File layout, all native endian:
+//      magic, version, fingerprint (uint64), document count, path count
+//      documents:  path index for each
+//      paths:      length then bytes for each
+//      trigrams, words:    key count, keys, offsets (key count + 1), docs
+static bool WriteArray( FILE * __nonnull file, const std::vector<uint32_t> & array )
+{
+    return array.empty() || 1 == fwrite( array.data(), array.size() * sizeof(uint32_t), 1, file);
+}
+
+// Bytes between the current position and the end of the file, used to check counts read from it before allocating
+static size_t BytesLeft( FILE * __nonnull file, size_t fileSize )
+{
+    off_t position = ftello( file);
+    return position < 0 || size_t(position) > fileSize ? 0 : fileSize - size_t(position);
+}
+
+static bool ReadArray( FILE * __nonnull file, size_t fileSize, std::vector<uint32_t> & array, size_t count )
+{
+    if( count > BytesLeft( file, fileSize) / sizeof(uint32_t) )
+        return false;
+    
+    array.resize( count);
+    return 0 == count || 1 == fread( array.data(), count * sizeof(uint32_t), 1, file);
+}
+
+bool PrismIndex::Save( const char * __nonnull path ) const
+{
+    FILE * file = fopen( path, "wb");
+    if( NULL == file )
+        return false;
+    
+    uint32_t header[2] = { kIndexMagic, kIndexVersion };
+    uint32_t counts[2] = { uint32_t(documents.size()), uint32_t(paths.size()) };
+    bool ok = 1 == fwrite( header, sizeof(header), 1, file) &&
+              1 == fwrite( &fingerprint, sizeof(fingerprint), 1, file) &&
+              1 == fwrite( counts, sizeof(counts), 1, file);
+    
+    std::vector<uint32_t> pathIndices;
+    pathIndices.reserve( documents.size());
+    for( const Document & d : documents )
+        pathIndices.push_back( d.path);
+    ok = ok && WriteArray( file, pathIndices);
+    
+    for( const std::string & p : paths )
+    {
+        uint32_t length = uint32_t( p.size());
+        ok = ok && 1 == fwrite( &length, sizeof(length), 1, file) &&
+                   (0 == length || 1 == fwrite( p.data(), length, 1, file));
+    }
+    
+    for( const PostingTable * table : { &trigrams, &words } )
+    {
+        uint32_t keyCount = uint32_t( table->keys.size());
+        uint32_t docCount = uint32_t( table->docs.size());
+        ok = ok && 1 == fwrite( &keyCount, sizeof(keyCount), 1, file) &&
+                   1 == fwrite( &docCount, sizeof(docCount), 1, file) &&
+                   WriteArray( file, table->keys) &&
+                   WriteArray( file, table->offsets) &&
+                   WriteArray( file, table->docs);
+    }
+    
+    if( fclose( file) )
+        ok = false;
+    
+    return ok;
+}
+
+bool PrismIndex::Load( const char * __nonnull path, const FileNode * __nonnull root )
+{
+    FILE * file = fopen( path, "rb");
+    if( NULL == file )
+        return false;
+    
+    struct stat info;
+    if( fstat( fileno(file), &info) )
+    {
+        fclose( file);
+        return false;
+    }
+    size_t fileSize = size_t( info.st_size);
+    
+    // The documents themselves come from the tree. The file says what they should look like.
+    CollectDocuments( root);
+    
+    uint32_t header[2];
+    uint64_t savedFingerprint;
+    uint32_t counts[2];
+    bool ok = 1 == fread( header, sizeof(header), 1, file) &&
+              header[0] == kIndexMagic && header[1] == kIndexVersion &&
+              1 == fread( &savedFingerprint, sizeof(savedFingerprint), 1, file) &&
+              1 == fread( counts, sizeof(counts), 1, file) &&
+              counts[0] == documents.size() && counts[1] == paths.size() &&
+              savedFingerprint == fingerprint;
+    
+    std::vector<uint32_t> pathIndices;
+    ok = ok && ReadArray( file, fileSize, pathIndices, counts[0]);
+    for( size_t i = 0; ok && i < documents.size(); i++)
+        ok = pathIndices[i] == documents[i].path;
+    
+    for( size_t i = 0; ok && i < paths.size(); i++)
+    {
+        uint32_t length;
+        ok = 1 == fread( &length, sizeof(length), 1, file) && length == paths[i].size() && length <= BytesLeft( file, fileSize);
+        if( ! ok )
+            break;
+        
+        std::string saved( length, '\0');
+        ok = (0 == length || 1 == fread( saved.data(), length, 1, file)) && saved == paths[i];
+    }
+    
+    for( PostingTable * table : { &trigrams, &words } )
+    {
+        uint32_t keyCount = 0, docCount = 0;
+        ok = ok && 1 == fread( &keyCount, sizeof(keyCount), 1, file) &&
+                   1 == fread( &docCount, sizeof(docCount), 1, file) &&
+                   ReadArray( file, fileSize, table->keys, keyCount) &&
+                   ReadArray( file, fileSize, table->offsets, size_t(keyCount) + 1) &&
+                   ReadArray( file, fileSize, table->docs, docCount) &&
+                   table->offsets.back() == docCount;
+        
+        for( size_t i = 0; ok && i < keyCount; i++)
+            ok = table->offsets[i] <= table->offsets[i+1];
+        for( size_t i = 0; ok && i < table->docs.size(); i++)
+            ok = table->docs[i] < documents.size();
+    }
+    
+    fclose( file);
+    
+    if( ! ok )
+    {
+        trigrams = PostingTable();
+        words = PostingTable();
+    }
+    
+    return ok;
+}
@@ -0,0 +1,108 @@
+//
+//  PrismIndex.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismIndex_h
+#define PrismIndex_h
+
+#include "FileNode.h"
+#include <vector>
+#include <string>
+
+/*! @abstract Full text index over the string values in a tree
+ *  @discussion Every string value inside an item (see FileNode::VisitItems) is a document. Each document remembers the item
+ *              that owns it and the path of keys from the item down to the string, e.g. "text" or "modifier/name".
+ *
+ *              Two posting tables are kept: lower case byte trigrams, for substring search, and lower case words, for word search.
+ *              Candidates from the tables are always checked against the text, so results are exact. Matching is case
+ *              insensitive for ASCII.
+ *
+ *              The index points into the tree it was built from and must not outlive it. Queries are const and may run on
+ *              many threads at once. */
+class PrismIndex
+{
+private:
+    typedef struct Document
+    {
+        const FileNodeSet * __nonnull   item;
+        const char * __nonnull          text;
+        uint32_t                        length;
+        uint32_t                        path;       // index into paths
+    }Document;
+    
+    /*! @abstract Sorted keys, each with a sorted list of documents */
+    typedef struct PostingTable
+    {
+        std::vector<uint32_t>   keys;
+        std::vector<uint32_t>   offsets;    // keys.size() + 1 entries. Postings for keys[i] are docs[offsets[i]...offsets[i+1]-1]
+        std::vector<uint32_t>   docs;
+    }PostingTable;
+    
+    std::vector<Document>       documents;
+    std::vector<std::string>    paths;
+    PostingTable                trigrams;
+    PostingTable                words;
+    uint64_t                    fingerprint;    // of the documents, to check that a saved index matches a tree
+    
+    struct CollectContext;
+    static void CollectStrings( const FileNode * __nullable node, CollectContext & c );
+    static void CollectItem( const FileNodeSet * __nonnull item, void * __nullable context );
+    void CollectDocuments( const FileNode * __nonnull root );
+    static void BuildTable( const std::vector<Document> & documents, bool byWord, unsigned threadCount, PostingTable & table );
+    static bool Lookup( const PostingTable & table, uint32_t key, const uint32_t * __nullable * __nonnull begin, const uint32_t * __nullable * __nonnull end );
+    
+public:
+    PrismIndex() : fingerprint(0){}
+    
+    /*! @abstract Index the strings in a tree, using threadCount threads or one per core if 0 */
+    void Build( const FileNode * __nonnull root, unsigned threadCount = 0 );
+    
+    /*! @abstract Write the index to disk, e.g. next to the .prism file it came from */
+    bool Save( const char * __nonnull path ) const;
+    
+    /*! @abstract Read an index written by Save()
+     *  @discussion root must be a tree parsed from the same data as the one the index was built from. Returns false if the file
+     *              can't be read or doesn't match root, in which case call Build() instead. */
+    bool Load( const char * __nonnull path, const FileNode * __nonnull root );
+    
+    inline unsigned long GetDocumentCount() const { return documents.size(); }
+    inline const FileNodeSet * __nonnull GetItem( uint32_t doc ) const { assert( doc < documents.size()); return documents[doc].item; }
+    inline const char * __nonnull GetText( uint32_t doc ) const { assert( doc < documents.size()); return documents[doc].text; }
+    inline const char * __nonnull GetKeyPath( uint32_t doc ) const { assert( doc < documents.size()); return paths[documents[doc].path].c_str(); }
+    
+    /*! @abstract Find the documents which contain text, ignoring case */
+    std::vector<uint32_t> FindSubstring( const char * __nonnull text ) const;
+    
+    /*! @abstract Find the documents which contain all of the words in text, ignoring case and order */
+    std::vector<uint32_t> FindWords( const char * __nonnull text ) const;
+    
+    /*! @abstract The distinct items which own a list of documents, in order of first appearance */
+    std::vector<const FileNodeSet *> GetItems( const std::vector<uint32_t> & docs ) const;
+};
+
+#endif /* PrismIndex_h */
@@ -0,0 +1,305 @@
+//
+//  PrismSampler.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismSampler.h"
+#include <time.h>
+#include <thread>
+
+// splitmix64, used to spread a seed out over the xoshiro state
+static inline uint64_t SplitMix64( uint64_t & x )
+{
+    uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void PrismRandom::Seed( uint64_t seed )
+{
+    for( int i = 0; i < 4; i++)
+        state[i] = SplitMix64(seed);
+}
+
+PrismRandom & PrismRandom::ThreadLocal()
+{
+    static thread_local bool seeded = false;
+    static thread_local PrismRandom random;
+    if( ! seeded )
+    {
+        struct timespec t;
+        clock_gettime( CLOCK_REALTIME, &t);
+        uint64_t seed = uint64_t(t.tv_sec) * 1000000000ULL + t.tv_nsec;
+        seed ^= std::hash<std::thread::id>()( std::this_thread::get_id() );
+        random.Seed(seed);
+        seeded = true;
+    }
+    
+    return random;
+}
+
+// Text used to group an item by a key's value
+static void AppendValueText( std::string & text, const FileNode * __nullable value )
+{
+    char buffer[32];
+    if( NULL == value )
+        return;
+    
+    switch( value->GetType() )
+    {
+        case NodeTypeString:
+            text += ((const FileNodeString *) value)->GetString();
+            break;
+        case NodeTypeInteger:
+            snprintf( buffer, sizeof(buffer), "%d", ((const FileNodeInt *) value)->GetValue());
+            text += buffer;
+            break;
+        case NodeTypeDouble:
+            snprintf( buffer, sizeof(buffer), "%g", ((const FileNodeDouble *) value)->GetValue());
+            text += buffer;
+            break;
+        case NodeTypeBoolean:
+            text += ((const FileNodeBoolean *) value)->GetValue() ? "true" : "false";
+            break;
+        default:
+            break;
+    }
+}
+
+PrismSampler::PrismSampler( const char * __nonnull const * __nonnull keyList, unsigned keyCount, PrismWeightFunction __nullable weight, void * __nullable context )
+    : weightFunc(weight), weightContext(context)
+{
+    for( unsigned i = 0; i < keyCount; i++)
+        keys.push_back( keyList[i] );
+}
+
+// Vose's variant of Walker's alias method. O(n) to build, O(1) to draw.
+void PrismSampler::BuildAliasTable( Group & group )
+{
+    unsigned long count = group.items.size();
+    group.probability.assign( count, 1.0);
+    group.alias.resize( count);
+    if( 0 == count )
+        return;
+    
+    double total = 0;
+    for( double w : group.weights )
+        total += w;
+    
+    std::vector<double> scaled( count);
+    std::vector<uint32_t> small, large;
+    for( unsigned long i = 0; i < count; i++)
+    {
+        scaled[i] = group.weights[i] * double(count) / total;
+        group.alias[i] = uint32_t(i);
+        if( scaled[i] < 1.0 )
+            small.push_back( uint32_t(i));
+        else
+            large.push_back( uint32_t(i));
+    }
+    
+    while( small.size() && large.size() )
+    {
+        uint32_t s = small.back();  small.pop_back();
+        uint32_t l = large.back();  large.pop_back();
+        
+        group.probability[s] = scaled[s];
+        group.alias[s] = l;
+        
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if( scaled[l] < 1.0 )
+            small.push_back(l);
+        else
+            large.push_back(l);
+    }
+    
+    // Anything left over is 1.0 give or take rounding error
+    for( uint32_t i : large )
+        group.probability[i] = 1.0;
+    for( uint32_t i : small )
+        group.probability[i] = 1.0;
+}
+
+// Weigh and group an item. Returns the group it went into, or -1 if its weight keeps it out of the sampler.
+long PrismSampler::Insert( const FileNodeSet * __nonnull item )
+{
+    double weight = weightFunc ? weightFunc( item, weightContext) : 1.0;
+    if( !(weight > 0) )
+        return -1;
+    
+    // Group name is the values joined with a character which shouldn't appear in any of them
+    std::string name;
+    for( const std::string & key : keys )
+    {
+        AppendValueText( name, item->GetValueForKey( key.c_str()));
+        name += '\x1f';
+    }
+    
+    unsigned long index;
+    auto found = groupIndex.find( name);
+    if( found == groupIndex.end() )
+    {
+        index = groups.size();
+        groupIndex.emplace( name, index);
+        groups.emplace_back();
+        
+        Group & group = groups.back();
+        size_t start = 0;
+        for( unsigned long k = 0; k < keys.size(); k++)
+        {
+            size_t end = name.find( '\x1f', start);
+            group.values.push_back( name.substr( start, end - start));
+            start = end + 1;
+        }
+    }
+    else
+        index = found->second;
+    
+    Group & group = groups[index];
+    locations[item] = Location{ index, group.items.size() };
+    group.items.push_back( item);
+    group.weights.push_back( weight);
+    return long(index);
+}
+
+// Take an item out of its group. Returns the group it was in, or -1 if it wasn't in the sampler.
+long PrismSampler::Erase( const FileNodeSet * __nonnull item )
+{
+    auto found = locations.find( item);
+    if( found == locations.end() )
+        return -1;
+    
+    Location where = found->second;
+    locations.erase( found);
+    
+    // Fill the hole with the last item in the group
+    Group & group = groups[where.group];
+    unsigned long last = group.items.size() - 1;
+    if( where.index != last )
+    {
+        group.items[where.index] = group.items[last];
+        group.weights[where.index] = group.weights[last];
+        locations[ group.items[where.index] ].index = where.index;
+    }
+    group.items.pop_back();
+    group.weights.pop_back();
+    return long(where.group);
+}
+
+unsigned long PrismSampler::BuildTouched( const std::vector<bool> & touched )
+{
+    unsigned long built = 0;
+    for( unsigned long g = 0; g < touched.size(); g++)
+        if( touched[g] )
+        {
+            BuildAliasTable( groups[g]);
+            built++;
+        }
+    
+    return built;
+}
+
+void PrismSampler::AddItem( const FileNodeSet * __nonnull item, void * __nullable context )
+{
+    ((PrismSampler *) context)->Insert( item);
+}
+
+unsigned long PrismSampler::Rebuild( const FileNode * __nonnull root )
+{
+    groups.clear();
+    groupIndex.clear();
+    locations.clear();
+    root->VisitItems( AddItem, this);
+    
+    for( Group & group : groups )
+        BuildAliasTable( group);
+    
+    return groups.size();
+}
+
+unsigned long PrismSampler::Update( const FileNodeSet * __nonnull const * __nonnull items, unsigned long count )
+{
+    std::vector<bool> touched( groups.size(), false);
+    for( unsigned long i = 0; i < count; i++)
+    {
+        long before = Erase( items[i]);
+        if( before >= 0 )
+            touched[before] = true;
+        
+        long after = Insert( items[i]);
+        if( after >= 0 )
+        {
+            if( (unsigned long) after >= touched.size() )
+                touched.resize( after + 1, false);
+            touched[after] = true;
+        }
+    }
+    
+    return BuildTouched( touched);
+}
+
+unsigned long PrismSampler::Remove( const FileNodeSet * __nonnull const * __nonnull items, unsigned long count )
+{
+    std::vector<bool> touched( groups.size(), false);
+    for( unsigned long i = 0; i < count; i++)
+    {
+        long before = Erase( items[i]);
+        if( before >= 0 )
+            touched[before] = true;
+    }
+    
+    return BuildTouched( touched);
+}
+
+long PrismSampler::FindGroup( const char * __nonnull const * __nonnull values ) const
+{
+    std::string name;
+    for( unsigned long k = 0; k < keys.size(); k++)
+    {
+        name += values[k];
+        name += '\x1f';
+    }
+    
+    auto found = groupIndex.find( name);
+    if( found == groupIndex.end() )
+        return -1;
+    
+    return long(found->second);
+}
+
+unsigned long PrismSampler::DrawBatch( unsigned long group, const FileNodeSet * __nullable * __nonnull result, unsigned long count, PrismRandom & random ) const
+{
+    assert(group < groups.size());
+    if( groups[group].items.empty() )
+        return 0;
+    
+    for( unsigned long i = 0; i < count; i++)
+        result[i] = Draw( group, random);
+    
+    return count;
+}
@@ -0,0 +1,178 @@
+//
+//  PrismSampler.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismSampler_h
+#define PrismSampler_h
+
+#include "FileNode.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+/*! @abstract A small, fast, seedable random number generator (xoshiro256**)
+ *  @discussion Not thread safe. Use one per thread. ThreadLocal() provides one. */
+class PrismRandom
+{
+private:
+    uint64_t    state[4];
+    
+    static inline uint64_t Rotate( uint64_t x, int k ){ return (x << k) | (x >> (64 - k)); }
+
+public:
+    PrismRandom( uint64_t seed = 0 ){ Seed(seed); }
+    
+    /*! @abstract Restart the sequence. The same seed always gives the same sequence. */
+    void Seed( uint64_t seed );
+    
+    /*! @abstract Return 64 random bits */
+    inline uint64_t Next()
+    {
+        uint64_t result = Rotate( state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = Rotate( state[3], 45);
+        return result;
+    }
+    
+    /*! @abstract Return a double in [0, 1) */
+    inline double NextDouble(){ return double(Next() >> 11) * 0x1.0p-53; }
+    
+    /*! @abstract Return an integer in [0, n) */
+    inline uint64_t NextBelow( uint64_t n ){ return (uint64_t)(((unsigned __int128) Next() * n) >> 64); }
+    
+    /*! @abstract The calling thread's generator
+     *  @discussion Seeded differently for each thread unless SeedThreadLocal() is called on that thread. */
+    static PrismRandom & ThreadLocal();
+    
+    /*! @abstract Seed the calling thread's generator, for reproducible rolls */
+    static inline void SeedThreadLocal( uint64_t seed ){ ThreadLocal().Seed(seed); }
+};
+
+/*! @abstract Callback to give the relative likelihood of drawing an item. Items with weight <= 0 are never drawn. */
+typedef double (*PrismWeightFunction)( const FileNodeSet * __nonnull item, void * __nullable context );
+
+/*! @abstract Draws random items from a tree in constant time
+ *  @discussion Items (see FileNode::VisitItems) are grouped by the values of one or more keys, e.g. "rarity" and "type".
+ *              A Walker alias table is built for each group, so a draw costs one random number and a table lookup no matter
+ *              how many items there are. Items missing a key are grouped under the empty string for that key.
+ *
+ *              Draws are const and may be made from many threads at once. Rebuild(), Update() and Remove() must not run
+ *              concurrently with them. */
+class PrismSampler
+{
+private:
+    typedef struct Group
+    {
+        std::vector<std::string>            values;     // one per key
+        std::vector<const FileNodeSet *>    items;
+        std::vector<double>                 weights;
+        std::vector<double>                 probability;
+        std::vector<uint32_t>               alias;
+    }Group;
+    
+    std::vector<std::string>                        keys;
+    PrismWeightFunction __nullable                  weightFunc;
+    void * __nullable                               weightContext;
+    typedef struct Location
+    {
+        unsigned long   group;
+        unsigned long   index;      // position in the group's items
+    }Location;
+    
+    std::vector<Group>                                  groups;
+    std::unordered_map<std::string, unsigned long>      groupIndex;
+    std::unordered_map<const FileNodeSet *, Location>   locations;
+    
+    static void BuildAliasTable( Group & group );
+    static void AddItem( const FileNodeSet * __nonnull item, void * __nullable context );
+    long Insert( const FileNodeSet * __nonnull item );
+    long Erase( const FileNodeSet * __nonnull item );
+    unsigned long BuildTouched( const std::vector<bool> & touched );
+
+public:
+    /*! @abstract Create an empty sampler. Call Rebuild() to fill it.
+     *  @param keys         the keys to group items by. Copied.
+     *  @param weight       weight callback, or NULL to weight all items equally */
+    PrismSampler( const char * __nonnull const * __nonnull keys, unsigned keyCount, PrismWeightFunction __nullable weight, void * __nullable context );
+    
+    /*! @abstract Replace the contents of the sampler with the items in a tree
+     *  @discussion A full rebuild: every item is weighed and grouped and every alias table is built from scratch.
+     *              Use Update() and Remove() when only a few items changed.
+     *  @return     The number of alias tables built */
+    unsigned long Rebuild( const FileNode * __nonnull root );
+    
+    /*! @abstract Add items, or re-weigh and regroup items already in the sampler after they were edited
+     *  @discussion Only the alias tables of groups which gained or lost an item are rebuilt, so the cost is proportional to
+     *              the size of those groups rather than the whole tree. Items whose weight is now <= 0 are removed.
+     *  @return     The number of alias tables rebuilt */
+    unsigned long Update( const FileNodeSet * __nonnull const * __nonnull items, unsigned long count );
+    
+    /*! @abstract Remove items, e.g. before they are deleted from the tree. Items not in the sampler are ignored.
+     *  @discussion Groups left empty stay in place, so group indices remain valid. Drawing from one returns NULL.
+     *  @return     The number of alias tables rebuilt */
+    unsigned long Remove( const FileNodeSet * __nonnull const * __nonnull items, unsigned long count );
+    
+    inline unsigned long GetGroupCount() const { return groups.size(); }
+    inline unsigned long GetItemCount( unsigned long group ) const { assert(group < groups.size()); return groups[group].items.size(); }
+    inline const char * __nonnull GetGroupValue( unsigned long group, unsigned keyIndex ) const
+    {
+        assert(group < groups.size() && keyIndex < keys.size());
+        return groups[group].values[keyIndex].c_str();
+    }
+    
+    /*! @abstract Find the group with the given values, one per key.
+     *  @return     The group index or -1 if no item has those values */
+    long FindGroup( const char * __nonnull const * __nonnull values ) const;
+    
+    /*! @abstract Draw a random item from a group. Returns NULL if the group is empty. */
+    inline const FileNodeSet * __nullable Draw( unsigned long group, PrismRandom & random = PrismRandom::ThreadLocal() ) const
+    {
+        assert(group < groups.size());
+        const Group & g = groups[group];
+        unsigned long count = g.items.size();
+        if( 0 == count )
+            return NULL;
+        
+        // One 64 bit draw: the high half picks the column, the low half is the coin. Alias indices are 32 bit, so count fits.
+        uint64_t bits = random.Next();
+        unsigned long i = (unsigned long)(((bits >> 32) * count) >> 32);
+        double coin = double( uint32_t(bits)) * 0x1.0p-32;
+        return coin < g.probability[i] ? g.items[i] : g.items[ g.alias[i] ];
+    }
+    
+    /*! @abstract Draw many random items from a group, with replacement
+     *  @return     The number of items written to result */
+    unsigned long DrawBatch( unsigned long group, const FileNodeSet * __nullable * __nonnull result, unsigned long count, PrismRandom & random = PrismRandom::ThreadLocal() ) const;
+};
+
+#endif /* PrismSampler_h */
@@ -0,0 +1,244 @@
+//
+//  PrismSchema.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismSchema.h"
+#include <ctype.h>
+#include <unordered_set>
+
+static const char * __nonnull TypeName( NodeType type )
+{
+    switch( type )
+    {
+        case NodeTypeKeyValuePair:  return "key-value pair";
+        case NodeTypeSet:           return "set";
+        case NodeTypeArray:         return "array";
+        case NodeTypeBoolean:       return "boolean";
+        case NodeTypeInteger:       return "integer";
+        case NodeTypeDouble:        return "double";
+        case NodeTypeString:        return "string";
+        default:                    return "mixed";
+    }
+}
+
+// C++ keywords and alternative tokens, which can't be used as member names
+static const char * __nonnull const kKeywords[] =
+{
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break", "case", "catch", "char",
+    "char16_t", "char32_t", "char8_t", "class", "co_await", "co_return", "co_yield", "compl", "concept", "const",
+    "const_cast", "consteval", "constexpr", "constinit", "continue", "decltype", "default", "delete", "do", "double",
+    "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if",
+    "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator", "or",
+    "or_eq", "private", "protected", "public", "register", "reinterpret_cast", "requires", "return", "short", "signed",
+    "sizeof", "static", "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local", "throw",
+    "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile",
+    "wchar_t", "while", "xor", "xor_eq"
+};
+
+static bool IsKeyword( const std::string & name )
+{
+    for( const char * keyword : kKeywords )
+        if( name == keyword )
+            return true;
+    return false;
+}
+
+// Print a key as the body of a C string literal
+static void PrintEscaped( const std::string & key )
+{
+    for( char c : key )
+    {
+        if( '"' == c || '\\' == c )
+            printf( "\\%c", c);
+        else if( (unsigned char) c < 0x20 || 0x7f == c )
+            printf( "\\%03o", (unsigned char) c);     // octal, since a hex escape would swallow any hex digits after it
+        else
+            putchar( c);
+    }
+}
+
+void PrismSchema::AddItem( const FileNodeSet * __nonnull item, void * __nullable context )
+{
+    PrismSchema & schema = *(PrismSchema *) context;
+    schema.itemCount++;
+    
+    for( const FileNode * node = item->GetSet(); node; node = node->GetNext() )
+    {
+        if( NodeTypeKeyValuePair != node->GetType() )
+            continue;
+        
+        const FileNodeKeyValuePair * pair = (const FileNodeKeyValuePair *) node;
+        auto found = schema.fieldIndex.find( pair->GetKey());
+        unsigned long index;
+        if( found == schema.fieldIndex.end() )
+        {
+            index = schema.fields.size();
+            schema.fieldIndex.emplace( pair->GetKey(), index);
+            schema.fields.push_back( Field());
+            schema.fields.back().key = pair->GetKey();
+        }
+        else
+            index = found->second;
+        
+        // A repeated key in one item counts once toward presence, but every value's type is noted
+        Field & field = schema.fields[index];
+        const FileNode * value = pair->GetValue();
+        NodeType type = value ? value->GetType() : NodeTypeSet;     // write() turns a missing value into {}
+        field.typeCounts[type]++;
+        field.present++;
+        for( const FileNode * p = item->GetSet(); p != node; p = p->GetNext() )
+            if( NodeTypeKeyValuePair == p->GetType() && 0 == strcmp( ((const FileNodeKeyValuePair *) p)->GetKey(), pair->GetKey()) )
+            {
+                field.present--;
+                break;
+            }
+    }
+}
+
+void PrismSchema::Infer( const FileNode * __nonnull root )
+{
+    itemCount = 0;
+    fields.clear();
+    fieldIndex.clear();
+    root->VisitItems( AddItem, this);
+}
+
+NodeType PrismSchema::GetFieldType( unsigned long index ) const
+{
+    const Field & field = GetField(index);
+    NodeType result = NodeTypeInvalid;
+    for( int type = NodeTypeKeyValuePair; type <= NodeTypeString; type++ )
+    {
+        if( 0 == field.typeCounts[type] )
+            continue;
+        
+        if( NodeTypeInvalid == result )
+            result = NodeType(type);
+        else if( (result == NodeTypeInteger && type == NodeTypeDouble) || (result == NodeTypeDouble && type == NodeTypeInteger) )
+            result = NodeTypeDouble;
+        else
+            return NodeTypeInvalid;
+    }
+    
+    return result;
+}
+
+void PrismSchema::Print() const
+{
+    printf( "%lu items, %lu keys\n", itemCount, fields.size());
+    for( unsigned long i = 0; i < fields.size(); i++ )
+    {
+        const Field & field = fields[i];
+        Indent(1);
+        printf( "\"%s\" : %s", field.key.c_str(), TypeName( GetFieldType(i)));
+        
+        if( NodeTypeInvalid == GetFieldType(i) )
+        {
+            printf( " (");
+            bool first = true;
+            for( int type = NodeTypeKeyValuePair; type <= NodeTypeString; type++ )
+                if( field.typeCounts[type] )
+                {
+                    printf( "%s%s %lu", first ? "" : ", ", TypeName( NodeType(type)), field.typeCounts[type]);
+                    first = false;
+                }
+            printf( ")");
+        }
+        
+        if( IsOptional(i) )
+            printf( ", optional (%lu of %lu)", field.present, itemCount);
+        printf( "\n");
+    }
+}
+
+void PrismSchema::PrintBinding( const char * __nonnull recordName ) const
+{
+    std::vector<std::string> members( fields.size());
+    std::unordered_set<std::string> used;
+    for( unsigned long i = 0; i < fields.size(); i++ )
+    {
+        // Make a C identifier from the key. Leading underscores and double underscores are reserved, so avoid making any.
+        std::string & name = members[i];
+        for( char c : fields[i].key )
+        {
+            if( isalnum( (unsigned char) c) )
+                name += c;
+            else if( name.size() && '_' != name.back() )
+                name += '_';
+        }
+        if( name.empty() || isdigit( (unsigned char) name[0]) )
+            name.insert( 0, "field_");
+        if( IsKeyword( name) )
+            name += '_';
+        
+        // Different keys can clean up to the same name, e.g. "a-b" and "a_b"
+        if( used.count( name) )
+        {
+            std::string base = '_' == name.back() ? name : name + '_';
+            for( unsigned long suffix = 2; used.count( name); suffix++ )
+                name = base + std::to_string( suffix);
+        }
+        used.insert( name);
+    }
+    
+    printf( "typedef struct %s\n{\n", recordName);
+    for( unsigned long i = 0; i < fields.size(); i++ )
+    {
+        const char * type = NULL;
+        switch( GetFieldType(i) )
+        {
+            case NodeTypeBoolean:   type = "bool";              break;
+            case NodeTypeInteger:   type = "int32_t";           break;
+            case NodeTypeDouble:    type = "double";            break;
+            case NodeTypeString:    type = "PrismStringRef";    break;
+            default:                continue;
+        }
+        
+        printf( "    %-16s%s;%s\n", type, members[i].c_str(), IsOptional(i) ? "     // optional" : "");
+    }
+    printf( "}%s;\n\n", recordName);
+    
+    printf( "static constexpr PrismField k%sFields[] =\n{\n", recordName);
+    for( unsigned long i = 0; i < fields.size(); i++ )
+    {
+        switch( GetFieldType(i) )
+        {
+            case NodeTypeBoolean:
+            case NodeTypeInteger:
+            case NodeTypeDouble:
+            case NodeTypeString:
+                printf( "    PRISM_FIELD( %s, %s, \"", recordName, members[i].c_str());
+                PrintEscaped( fields[i].key);
+                printf( "\" ),\n");
+                break;
+            default:
+                break;
+        }
+    }
+    printf( "};\n");
+}
@@ -0,0 +1,81 @@
+//
+//  PrismSchema.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismSchema_h
+#define PrismSchema_h
+
+#include "FileNode.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+/*! @abstract Describes the keys found in the items of a tree
+ *  @discussion Looks at the key-value pairs directly inside each item (see FileNode::VisitItems) and records which keys appear,
+ *              what types their values have and how many items have them. A key missing from some items is optional. */
+class PrismSchema
+{
+public:
+    typedef struct Field
+    {
+        std::string     key;
+        unsigned long   present;                        // number of items with this key
+        unsigned long   typeCounts[NodeTypeString + 1]; // indexed by NodeType
+    }Field;
+    
+private:
+    unsigned long                                   itemCount;
+    std::vector<Field>                              fields;     // in order of first appearance
+    std::unordered_map<std::string, unsigned long>  fieldIndex;
+    
+    static void AddItem( const FileNodeSet * __nonnull item, void * __nullable context );
+
+public:
+    PrismSchema() : itemCount(0){}
+    
+    /*! @abstract Gather the schema of the items in a tree. Replaces anything found before. */
+    void Infer( const FileNode * __nonnull root );
+    
+    inline unsigned long GetItemCount() const { return itemCount; }
+    inline unsigned long GetFieldCount() const { return fields.size(); }
+    inline const Field & GetField( unsigned long index ) const { assert( index < fields.size()); return fields[index]; }
+    inline bool IsOptional( unsigned long index ) const { return GetField(index).present < itemCount; }
+    
+    /*! @abstract The type which can hold every value seen for a field
+     *  @discussion Integers and doubles together give NodeTypeDouble. Any other mix gives NodeTypeInvalid. */
+    NodeType GetFieldType( unsigned long index ) const;
+    
+    /*! @abstract Print human readable version */
+    void Print() const;
+    
+    /*! @abstract Print a C++ record and PrismField table for use with PrismBindRecords()
+     *  @discussion Fields which aren't integers, doubles, booleans or strings are left out. */
+    void PrintBinding( const char * __nonnull recordName ) const;
+};
+
+#endif /* PrismSchema_h */
@@ -0,0 +1,770 @@
+//
+//  PrismServer.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismServer.h"
+#include "PrismStream.h"
+#include "PrismThreads.h"
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+template <typename T>  T min( T a, T b){ return a < b ? a : b;}
+template <typename T>  T max( T a, T b){ return a > b ? a : b;}
+
+// A connection is dropped if a request takes longer than this to arrive in full, or its response takes longer than this to send.
+// So a client that stalls partway through a request or stops reading its responses can't hold on to a worker.
+static const int kPrismRequestTimeoutMilliseconds = 5000;
+
+// Limits on how often the watcher looks at the databases
+static const unsigned kPrismMinReloadMilliseconds = 10;
+static const unsigned kPrismMaxReloadMilliseconds = 24 * 60 * 60 * 1000;
+
+typedef std::chrono::steady_clock::time_point Deadline;
+
+// Wait until fd is ready for events, or the deadline passes
+static bool WaitBefore( int fd, short events, Deadline deadline )
+{
+    while( 1 )
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>( deadline - std::chrono::steady_clock::now()).count();
+        if( left <= 0 )
+            return false;
+        
+        struct pollfd p = { fd, events, 0 };
+        int ready = poll( &p, 1, (int) left);
+        if( ready < 0 && errno != EINTR )
+            return false;
+        if( ready > 0 )
+            return true;
+    }
+}
+
+// PrismWriteFully(), but the whole write must finish before the deadline, however slowly the client reads
+static bool WriteBefore( int fd, const void * __nonnull buffer, size_t size, Deadline deadline )
+{
+    const char * p = (const char *) buffer;
+    while( size )
+    {
+        if( ! WaitBefore( fd, POLLOUT, deadline) )
+            return false;
+        
+        ssize_t bytes = send( fd, p, size, MSG_DONTWAIT);
+        if( bytes < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) )
+            continue;
+        if( bytes <= 0 )
+            return false;
+        
+        p += bytes;
+        size -= bytes;
+    }
+    
+    return true;
+}
+
+/*! @abstract A client connection and the bytes it has sent which haven't been answered yet */
+struct PrismServer::Connection
+{
+    int             fd;
+    std::string     input;          // may hold the start of a request, or several pipelined ones
+    Deadline        started;        // when the oldest unanswered bytes in input arrived
+    
+    Connection( int f ) : fd(f){}
+    ~Connection(){ close( fd); }
+};
+
+// Size of the first request in input: 0 if it hasn't all arrived yet, -1 if it is too big to ever accept
+static long RequestSize( const std::string & input )
+{
+    if( input.size() < sizeof(PrismRequestHeader) )
+        return 0;
+    
+    PrismRequestHeader header;
+    memcpy( &header, input.data(), sizeof(header));
+    if( header.length > kPrismMaxRequestLength )
+        return -1;
+    
+    size_t size = sizeof(header) + header.length;
+    return input.size() >= size ? long(size) : 0;
+}
+
+/*! @abstract Everything needed to answer requests from one version of a database. Never changes once built. */
+struct PrismServer::Snapshot
+{
+    FileNode * __nonnull                                        root;
+    std::vector<const FileNodeSet *>                            items;
+    std::unordered_map<std::string, const FileNodeSet *>        byLookupKey;
+    PrismSampler                                                sampler;
+    
+    Snapshot( FileNode * __nonnull tree, const std::vector<const char *> & groupKeys ) :
+        root(tree), sampler( groupKeys.data(), (unsigned) groupKeys.size(), NULL, NULL){}
+    ~Snapshot(){ delete root; }
+};
+
+static void CollectItem( const FileNodeSet * __nonnull item, void * __nullable context )
+{
+    ((std::vector<const FileNodeSet *> *) context)->push_back( item);
+}
+
+// Does a value read as text?  Strings compare as is. Numbers and booleans compare as they would be written, and doubles
+// also match text which is entirely a number equal to the value.
+static bool ValueEquals( const FileNode * __nullable value, const char * __nonnull text )
+{
+    char buffer[32];
+    if( NULL == value )
+        return false;
+    
+    switch( value->GetType() )
+    {
+        case NodeTypeString:
+            return 0 == strcmp( ((const FileNodeString *) value)->GetString(), text);
+        case NodeTypeInteger:
+            snprintf( buffer, sizeof(buffer), "%d", ((const FileNodeInt *) value)->GetValue());
+            return 0 == strcmp( buffer, text);
+        case NodeTypeDouble:
+        {
+            // Either the text as written, or a number which parses to exactly the value, e.g. "0.50" for 0.5
+            char written[30];
+            ((const FileNodeDouble *) value)->GetText( written);
+            if( 0 == strcmp( written, text) )
+                return true;
+            
+            char * end = NULL;
+            double number = strtod( text, &end);
+            return '\0' != text[0] && ! isspace( (unsigned char) text[0]) && '\0' == *end &&
+                   ((const FileNodeDouble *) value)->GetValue() == number;
+        }
+        case NodeTypeBoolean:
+            return 0 == strcasecmp( ((const FileNodeBoolean *) value)->GetValue() ? "true" : "false", text);
+        default:
+            return false;
+    }
+}
+
+static ssize_t AppendToString( void * cookie, const char * bytes, size_t count )
+{
+    ((std::string *) cookie)->append( bytes, count);
+    return (ssize_t) count;
+}
+
+// Serialize an item onto the end of a response
+static void AppendItem( std::string & response, const FileNodeSet * __nonnull item, bool first )
+{
+    if( ! first )
+        response += '\n';
+    
+    FILE * file = OpenWriteCookie( &response, AppendToString, NULL);
+    if( NULL == file )
+        return;
+    
+    item->write( file);
+    fclose( file);
+}
+
+bool PrismReadFully( int fd, void * __nonnull buffer, size_t size )
+{
+    char * p = (char *) buffer;
+    while( size )
+    {
+        ssize_t bytes = read( fd, p, size);
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes <= 0 )
+            return false;
+        
+        p += bytes;
+        size -= bytes;
+    }
+    
+    return true;
+}
+
+bool PrismWriteFully( int fd, const void * __nonnull buffer, size_t size )
+{
+    const char * p = (const char *) buffer;
+    while( size )
+    {
+        ssize_t bytes = write( fd, p, size);
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes <= 0 )
+            return false;
+        
+        p += bytes;
+        size -= bytes;
+    }
+    
+    return true;
+}
+
+static inline bool IsSameFile( const struct stat & a, const struct stat & b )
+{
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size &&
+#if defined( __APPLE__ )
+           a.st_mtimespec.tv_sec == b.st_mtimespec.tv_sec && a.st_mtimespec.tv_nsec == b.st_mtimespec.tv_nsec;
+#else
+           a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+#endif
+}
+
+PrismServer::PrismServer( const PrismServerOptions & o ) : options(o), stopping(false), listener(-1)
+{
+    wake[0] = wake[1] = -1;
+    halt[0] = halt[1] = -1;
+    options.reloadMilliseconds = min( max( options.reloadMilliseconds, kPrismMinReloadMilliseconds), kPrismMaxReloadMilliseconds);
+    if( 0 == options.threadCount )
+        options.threadCount = DefaultThreadCount();
+    
+    hazards.reset( new std::atomic<const Snapshot *>[ options.threadCount ]);
+    for( unsigned i = 0; i < options.threadCount; i++ )
+        hazards[i].store( NULL);
+}
+
+PrismServer::~PrismServer()
+{
+    for( Database * database : databases )
+    {
+        delete database->current.load();
+        delete database;
+    }
+}
+
+const PrismServer::Snapshot * __nullable PrismServer::LoadSnapshot( const char * __nonnull path ) const
+{
+    FileNode * root = ParseCompressedFile( path);
+    if( NULL == root )
+        return NULL;
+    
+    Snapshot * snapshot = new Snapshot( root, options.groupKeys);
+    root->VisitItems( CollectItem, &snapshot->items);
+    for( const FileNodeSet * item : snapshot->items )
+    {
+        const FileNode * value = item->GetValueForKey( options.lookupKey);
+        if( value && NodeTypeString == value->GetType() )
+            snapshot->byLookupKey.emplace( ((const FileNodeString *) value)->GetString(), item);     // first one wins
+    }
+    snapshot->sampler.Rebuild( root);
+    
+    return snapshot;
+}
+
+bool PrismServer::AddDatabase( const char * __nonnull path )
+{
+    Database * database = new Database();
+    database->path = path;
+    
+    // stat first, so a change while we are parsing is noticed later
+    if( stat( path, &database->info) )
+    {
+        delete database;
+        return false;
+    }
+    
+    const Snapshot * snapshot = LoadSnapshot( path);
+    if( NULL == snapshot )
+    {
+        delete database;
+        return false;
+    }
+    
+    database->current.store( snapshot);
+    databases.push_back( database);
+    return true;
+}
+
+// Publish which snapshot this worker is using, then check it is still current. If it isn't, the watcher may have missed our
+// hazard pointer, so try again.
+const PrismServer::Snapshot * __nonnull PrismServer::Acquire( const Database & database, unsigned worker )
+{
+    const Snapshot * snapshot;
+    do
+    {
+        snapshot = database.current.load();
+        hazards[worker].store( snapshot);
+    }while( snapshot != database.current.load() );
+    
+    return snapshot;
+}
+
+void PrismServer::Release( unsigned worker )
+{
+    hazards[worker].store( NULL);
+}
+
+// Free a snapshot which has been replaced, once no worker holds it
+void PrismServer::Retire( const Snapshot * __nonnull snapshot )
+{
+    for( unsigned i = 0; i < options.threadCount; i++ )
+        while( hazards[i].load() == snapshot )
+            std::this_thread::sleep_for( std::chrono::milliseconds(1));
+    
+    delete snapshot;
+}
+
+void PrismServer::Watcher()
+{
+    while( ! stopping.load() )
+    {
+        // Sleep, unless Stop() writes to halt first
+        struct pollfd p = { halt[0], POLLIN, 0 };
+        if( poll( &p, 1, (int) options.reloadMilliseconds) > 0 )
+            break;
+        
+        for( Database * database : databases )
+        {
+            struct stat info;
+            if( stat( database->path.c_str(), &info) || IsSameFile( info, database->info) )
+                continue;
+            
+            const Snapshot * snapshot = LoadSnapshot( database->path.c_str());
+            if( NULL == snapshot )
+            {
+                // Maybe caught it half written. Keep serving the old one and look again next time.
+                fprintf( stderr, "Reload of \"%s\" failed\n", database->path.c_str());
+                continue;
+            }
+            
+            database->info = info;
+            Retire( database->current.exchange( snapshot));
+            fprintf( stderr, "Reloaded \"%s\"\n", database->path.c_str());
+        }
+    }
+}
+
+PrismStatus PrismServer::Handle( const PrismRequestHeader & header, const std::string & payload, unsigned worker, std::string & response )
+{
+    if( header.database >= databases.size() )
+        return PrismStatusBadRequest;
+    
+    // payload is a list of '\0' separated strings
+    std::vector<const char *> arguments;
+    for( size_t start = 0; start < payload.size(); start += strlen( payload.c_str() + start) + 1 )
+        arguments.push_back( payload.c_str() + start);
+    
+    PrismStatus status = PrismStatusOK;
+    const Snapshot * snapshot = Acquire( *databases[header.database], worker);
+    switch( header.op )
+    {
+        case PrismOpLookup:
+        {
+            auto found = snapshot->byLookupKey.find( arguments.size() ? arguments[0] : "");
+            if( found == snapshot->byLookupKey.end() )
+                status = PrismStatusNotFound;
+            else
+                AppendItem( response, found->second, true);
+            break;
+        }
+        case PrismOpFilter:
+        {
+            if( arguments.size() != 2 )
+            {
+                status = PrismStatusBadRequest;
+                break;
+            }
+            
+            uint32_t matches = 0;
+            response.append( sizeof(matches), '\0');
+            size_t countOffset = response.size() - sizeof(matches);
+            for( const FileNodeSet * item : snapshot->items )
+                if( ValueEquals( item->GetValueForKey( arguments[0]), arguments[1]) )
+                {
+                    if( matches < header.count )
+                        AppendItem( response, item, 0 == matches);
+                    matches++;
+                }
+            memcpy( &response[countOffset], &matches, sizeof(matches));
+            break;
+        }
+        case PrismOpDraw:
+        {
+            if( arguments.size() != options.groupKeys.size() )
+            {
+                status = PrismStatusBadRequest;
+                break;
+            }
+            
+            long group = snapshot->sampler.FindGroup( arguments.data());
+            if( group < 0 || 0 == snapshot->sampler.GetItemCount( group) )
+            {
+                status = PrismStatusNotFound;
+                break;
+            }
+            
+            for( unsigned i = 0; i < max( header.count, (uint16_t) 1); i++ )
+                AppendItem( response, snapshot->sampler.Draw( group), 0 == i);
+            break;
+        }
+        default:
+            status = PrismStatusBadRequest;
+            break;
+    }
+    Release( worker);
+    
+    return status;
+}
+
+// Answer the first request in a connection's input. Returns false if the connection should be closed.
+bool PrismServer::Serve( Connection & connection, unsigned worker, std::string & response, std::string & payload )
+{
+    PrismRequestHeader header;
+    memcpy( &header, connection.input.data(), sizeof(header));
+    payload.assign( connection.input, sizeof(header), header.length);
+    connection.input.erase( 0, sizeof(header) + header.length);
+    connection.started = std::chrono::steady_clock::now();     // for whatever of the next request is already here
+    
+    response.assign( sizeof(PrismResponseHeader), '\0');
+    PrismStatus status = Handle( header, payload, worker, response);
+    if( PrismStatusOK != status )
+        response.resize( sizeof(PrismResponseHeader));
+    
+    PrismResponseHeader * responseHeader = (PrismResponseHeader *) &response[0];
+    responseHeader->length = uint32_t( response.size() - sizeof(PrismResponseHeader));
+    responseHeader->status = status;
+    
+    Deadline deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( kPrismRequestTimeoutMilliseconds);
+    return WriteBefore( connection.fd, response.data(), response.size(), deadline);
+}
+
+void PrismServer::Worker( unsigned worker )
+{
+    std::string response, payload;     // reused from request to request
+    while( 1 )
+    {
+        Connection * connection;
+        {
+            std::unique_lock<std::mutex> guard( lock);
+            changed.wait( guard, [this]{ return stopping.load() || ready.size(); });
+            if( stopping.load() )
+                return;
+            
+            connection = ready.back();
+            ready.pop_back();
+        }
+        
+        if( ! Serve( *connection, worker, response, payload) )
+        {
+            delete connection;
+            continue;
+        }
+        
+        // Hand the connection back to be polled for its next request
+        {
+            std::lock_guard<std::mutex> guard( lock);
+            returned.push_back( connection);
+        }
+        char c = 0;
+        (void) write( wake[1], &c, 1);     // non-blocking. If the pipe is full, Run() is already due to wake up.
+    }
+}
+
+// Create the socket. Refuses to replace anything but a stale socket.
+bool PrismServer::Listen()
+{
+    struct sockaddr_un address;
+    memset( &address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if( strlen( options.socketPath) >= sizeof(address.sun_path) )
+        return false;
+    strncpy( address.sun_path, options.socketPath, sizeof(address.sun_path) - 1);
+    
+    struct stat info;
+    if( 0 == lstat( options.socketPath, &info) )
+    {
+        if( ! S_ISSOCK( info.st_mode) )
+        {
+            fprintf( stderr, "\"%s\" exists and is not a socket\n", options.socketPath);
+            return false;
+        }
+        
+        // A socket nobody answers on was left behind by an earlier run. One that answers belongs to a live server.
+        int probe = socket( AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && 0 == connect( probe, (struct sockaddr *) &address, sizeof(address));
+        if( probe >= 0 )
+            close( probe);
+        if( live )
+        {
+            fprintf( stderr, "Another server is listening on \"%s\"\n", options.socketPath);
+            return false;
+        }
+        
+        unlink( options.socketPath);
+    }
+    
+    listener = socket( AF_UNIX, SOCK_STREAM, 0);
+    if( listener < 0 )
+        return false;
+    
+    if( bind( listener, (struct sockaddr *) &address, sizeof(address)) || listen( listener, 128) )
+    {
+        close( listener);
+        listener = -1;
+        return false;
+    }
+    
+    if( pipe( wake) )
+    {
+        close( listener);
+        listener = -1;
+        unlink( options.socketPath);
+        return false;
+    }
+    if( pipe( halt) )
+    {
+        for( int & fd : wake )
+        {
+            close( fd);
+            fd = -1;
+        }
+        close( listener);
+        listener = -1;
+        unlink( options.socketPath);
+        return false;
+    }
+    for( int fd : { wake[0], wake[1], halt[0], halt[1] } )
+        fcntl( fd, F_SETFL, fcntl( fd, F_GETFL) | O_NONBLOCK);
+    
+    return true;
+}
+
+// Read what a connection has sent. Returns false if it hung up, failed or sent something unacceptable.
+bool PrismServer::ReceiveInput( Connection & connection )
+{
+    char buffer[16 * 1024];
+    while( connection.input.size() < sizeof(PrismRequestHeader) + kPrismMaxRequestLength )
+    {
+        ssize_t bytes = recv( connection.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) )
+            break;
+        if( bytes <= 0 )
+            return false;
+        
+        if( connection.input.empty() )
+            connection.started = std::chrono::steady_clock::now();
+        connection.input.append( buffer, bytes);
+    }
+    
+    return RequestSize( connection.input) >= 0;
+}
+
+// Wait for input on idle connections and pass whole requests to the workers. Also accepts new connections.
+void PrismServer::Poll()
+{
+    std::vector<struct pollfd> polled;
+    polled.push_back( { listener, POLLIN, 0 });
+    polled.push_back( { wake[0], POLLIN, 0 });
+    for( Connection * connection : idle )
+        polled.push_back( { connection->fd, POLLIN, 0 });
+    
+    // time out now and then as a backstop for Stop(), and to drop requests which are taking too long to arrive
+    int polledCount = poll( polled.data(), (nfds_t) polled.size(), 250);
+    
+    std::vector<Connection *> candidates;
+    for( size_t i = 0; i < idle.size(); i++ )
+    {
+        Connection * connection = idle[i];
+        if( polledCount > 0 && polled[i + 2].revents && ! ReceiveInput( *connection) )
+            delete connection;
+        else
+            candidates.push_back( connection);
+    }
+    idle.clear();
+    
+    if( polledCount > 0 && polled[1].revents )
+    {
+        char drain[64];
+        while( read( wake[0], drain, sizeof(drain)) > 0 ){}
+    }
+    
+    {
+        std::lock_guard<std::mutex> guard( lock);
+        
+        // Answered connections come back here too. Their input may already hold the next request.
+        candidates.insert( candidates.end(), returned.begin(), returned.end());
+        returned.clear();
+        
+        Deadline expired = std::chrono::steady_clock::now() - std::chrono::milliseconds( kPrismRequestTimeoutMilliseconds);
+        size_t readyBefore = ready.size();
+        for( Connection * connection : candidates )
+        {
+            if( RequestSize( connection->input) > 0 )
+                ready.push_back( connection);
+            else if( connection->input.size() && connection->started < expired )
+                delete connection;
+            else
+                idle.push_back( connection);
+        }
+        
+        if( ready.size() > readyBefore + 1 )
+            changed.notify_all();
+        else if( ready.size() > readyBefore )
+            changed.notify_one();
+    }
+    
+    if( polledCount > 0 && polled[0].revents )
+    {
+        int fd = accept( listener, NULL, NULL);
+        if( fd >= 0 )
+            idle.push_back( new Connection( fd));
+        else if( errno == EMFILE || errno == ENFILE )
+            std::this_thread::sleep_for( std::chrono::milliseconds(10));     // out of descriptors. Don't spin.
+    }
+}
+
+bool PrismServer::Run()
+{
+    if( ! Listen() )
+        return false;
+    
+    std::vector<std::thread> workers;
+    for( unsigned i = 0; i < options.threadCount; i++ )
+        workers.emplace_back( &PrismServer::Worker, this, i);
+    std::thread watcher( &PrismServer::Watcher, this);
+    
+    while( ! stopping.load() )
+        Poll();
+    
+    {
+        std::lock_guard<std::mutex> guard( lock);
+        changed.notify_all();
+    }
+    for( std::thread & t : workers )
+        t.join();
+    watcher.join();
+    
+    for( std::vector<Connection *> * list : { &idle, &ready, &returned } )
+    {
+        for( Connection * connection : *list )
+            delete connection;
+        list->clear();
+    }
+    close( listener);
+    listener = -1;
+    for( int * pair : { wake, halt } )
+        for( int i = 0; i < 2; i++ )
+        {
+            close( pair[i]);
+            pair[i] = -1;
+        }
+    unlink( options.socketPath);
+    return true;
+}
+
+// Only async signal safe calls here. Workers waiting for requests are woken by Run() on its way out.
+void PrismServer::Stop()
+{
+    stopping.store( true);
+    char c = 0;
+    if( wake[1] >= 0 )
+        (void) write( wake[1], &c, 1);
+    if( halt[1] >= 0 )
+        (void) write( halt[1], &c, 1);     // never drained, so the watcher sees it whenever it next looks
+}
+
+static PrismServer * __nullable gServer = NULL;
+
+static void StopServer( int )
+{
+    int savedErrno = errno;
+    if( gServer )
+        gServer->Stop();
+    errno = savedErrno;
+}
+
+int PrismServerMain( int argc, const char * __nonnull argv[__nonnull] )
+{
+    // -serve socket [-t threads] [-key name] [-group key]... [-reload ms] database.prism...
+    if( argc < 3 )
+    {
+        fprintf( stderr, "usage: %s -serve socket [-t threads] [-key name] [-group key]... [-reload ms] database.prism...\n", argv[0]);
+        return -1;
+    }
+    
+    PrismServerOptions options;
+    options.socketPath = argv[2];
+    options.lookupKey = "name";
+    options.threadCount = 0;
+    options.reloadMilliseconds = 1000;
+    
+    int i = 3;
+    for( ; i + 1 < argc && argv[i][0] == '-'; i += 2 )
+    {
+        if( 0 == strcmp( argv[i], "-t") )
+            options.threadCount = (unsigned) atoi( argv[i+1]);
+        else if( 0 == strcmp( argv[i], "-key") )
+            options.lookupKey = argv[i+1];
+        else if( 0 == strcmp( argv[i], "-group") )
+            options.groupKeys.push_back( argv[i+1]);
+        else if( 0 == strcmp( argv[i], "-reload") )
+        {
+            char * end = NULL;
+            long milliseconds = strtol( argv[i+1], &end, 10);
+            if( '\0' == argv[i+1][0] || '\0' != *end || milliseconds < (long) kPrismMinReloadMilliseconds ||
+                milliseconds > (long) kPrismMaxReloadMilliseconds )
+            {
+                fprintf( stderr, "-reload must be between %u and %u milliseconds\n", kPrismMinReloadMilliseconds, kPrismMaxReloadMilliseconds);
+                return -1;
+            }
+            options.reloadMilliseconds = (unsigned) milliseconds;
+        }
+        else
+            break;
+    }
+    
+    // A client hanging up mid-response shouldn't take the server down
+    signal( SIGPIPE, SIG_IGN);
+    
+    PrismServer server( options);
+    for( int database = 0; i < argc; i++, database++ )
+    {
+        if( ! server.AddDatabase( argv[i]) )
+        {
+            fprintf( stderr, "Load of \"%s\" failed\n", argv[i]);
+            return -1;
+        }
+        fprintf( stderr, "Database %d: \"%s\"\n", database, argv[i]);
+    }
+    
+    // Only once nothing can return early, so the handlers are always put back before server goes away
+    gServer = &server;
+    signal( SIGINT, StopServer);
+    signal( SIGTERM, StopServer);
+    
+    int result = server.Run() ? 0 : -1;
+    signal( SIGINT, SIG_DFL);
+    signal( SIGTERM, SIG_DFL);
+    gServer = NULL;
+    return result;
+}
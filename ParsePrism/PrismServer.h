@@ -0,0 +1,166 @@
+//
+//  PrismServer.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismServer_h
+#define PrismServer_h
+
+#include "FileNode.h"
+#include "PrismSampler.h"
+#include <sys/stat.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+
+// Request/response protocol over a Unix domain socket. All fields are native endian since both ends are on the same machine.
+// A connection carries any number of requests, each answered in order.
+
+/*! @abstract Operations a client can ask for */
+typedef enum PrismOp : uint8_t
+{
+    PrismOpLookup = 0,      // payload: value of the lookup key.                  response: the item, as write() would have it
+    PrismOpFilter,          // payload: key '\0' value.                           response: uint32 match count, then up to count items
+    PrismOpDraw             // payload: one value per group key, '\0' separated.  response: count random items
+}PrismOp;
+
+/*! @abstract Result of a request */
+typedef enum PrismStatus : uint8_t
+{
+    PrismStatusOK = 0,
+    PrismStatusNotFound,
+    PrismStatusBadRequest
+}PrismStatus;
+
+typedef struct PrismRequestHeader
+{
+    uint32_t    length;         // of the payload which follows
+    uint8_t     op;             // PrismOp
+    uint8_t     database;       // index, in the order given to the server
+    uint16_t    count;          // items wanted from PrismOpFilter and PrismOpDraw. 0 means 1 for PrismOpDraw.
+}PrismRequestHeader;
+
+typedef struct PrismResponseHeader
+{
+    uint32_t    length;         // of the payload which follows. Multiple items are separated by '\n'.
+    uint8_t     status;         // PrismStatus
+    uint8_t     reserved[3];
+}PrismResponseHeader;
+
+static const uint32_t kPrismMaxRequestLength = 64 * 1024;
+
+/*! @abstract Read exactly size bytes from a socket, retrying short reads and EINTR. Returns false on error or end of file. */
+bool PrismReadFully( int fd, void * __nonnull buffer, size_t size );
+
+/*! @abstract Write exactly size bytes to a socket, retrying short writes and EINTR. Returns false on error. */
+bool PrismWriteFully( int fd, const void * __nonnull buffer, size_t size );
+
+typedef struct PrismServerOptions
+{
+    const char * __nonnull              socketPath;
+    const char * __nonnull              lookupKey;          // PrismOpLookup finds items by this key, e.g. "name"
+    std::vector<const char *>           groupKeys;          // PrismOpDraw groups items by these keys, e.g. "rarity"
+    unsigned                            threadCount;        // workers, or 0 for one per core. Each answers one request at a time.
+    unsigned                            reloadMilliseconds; // how often to check the databases for changes on disk. 10 ms to 24 hours.
+}PrismServerOptions;
+
+/*! @abstract Serves lookups, filters and random draws from databases held in memory
+ *  @discussion Each database is an immutable snapshot: the parsed tree plus lookup table and sampler. Workers read snapshots
+ *              without taking locks. A watcher thread notices when a file changes on disk, parses it into a new snapshot and
+ *              swaps it in atomically. The old one is freed once no worker is still using it (hazard pointers).
+ *
+ *              Run() polls every open connection and reads whatever arrives. Once a connection holds a whole request it goes to
+ *              the next free worker, which answers that one request and hands the connection back. So any number of clients can
+ *              stay connected however few workers there are, and a client that trickles in a request never ties up a worker. */
+class PrismServer
+{
+private:
+    struct Snapshot;
+    struct Connection;
+    
+    typedef struct Database
+    {
+        std::string                         path;
+        std::atomic<const Snapshot *>       current;
+        struct stat                         info;       // of the file current was loaded from
+    }Database;
+    
+    PrismServerOptions                      options;
+    std::vector<Database *>                 databases;
+    
+    // One hazard pointer per worker: the snapshot it is reading, if any
+    std::unique_ptr< std::atomic<const Snapshot *>[] > hazards;
+    
+    // Connections move from idle (polled by Run) to ready (a whole request is waiting for a worker) to returned (answered,
+    // waiting to be polled again). Only Run() touches idle. Workers write to wake to let it know something was returned.
+    std::vector<Connection *>               idle;
+    std::vector<Connection *>               ready;
+    std::vector<Connection *>               returned;
+    std::mutex                              lock;
+    std::condition_variable                 changed;
+    std::atomic<bool>                       stopping;
+    int                                     listener;
+    int                                     wake[2];
+    int                                     halt[2];    // Stop() writes here to wake the watcher
+    
+    const Snapshot * __nullable LoadSnapshot( const char * __nonnull path ) const;
+    const Snapshot * __nonnull  Acquire( const Database & database, unsigned worker );
+    void                        Release( unsigned worker );
+    void                        Retire( const Snapshot * __nonnull snapshot );
+    
+    void Worker( unsigned worker );
+    void Watcher();
+    bool Serve( Connection & connection, unsigned worker, std::string & response, std::string & payload );
+    bool Listen();
+    void Poll();
+    static bool ReceiveInput( Connection & connection );
+    PrismStatus Handle( const PrismRequestHeader & header, const std::string & payload, unsigned worker, std::string & response );
+
+public:
+    PrismServer( const PrismServerOptions & options );
+    ~PrismServer();
+    
+    /*! @abstract Load a database. Databases are numbered in the order they are added. */
+    bool AddDatabase( const char * __nonnull path );
+    
+    /*! @abstract Listen on the socket and answer requests until Stop() */
+    bool Run();
+    
+    /*! @abstract Make Run() return. Safe to call from another thread or a signal handler. */
+    void Stop();
+};
+
+/*! @abstract  ParsePrism -serve socket [-t threads] [-key name] [-group key]... [-reload ms] database.prism...
+ *  @discussion Runs a server from the command line until SIGINT or SIGTERM */
+int PrismServerMain( int argc, const char * __nonnull argv[__nonnull] );
+
+#endif /* PrismServer_h */
@@ -0,0 +1,880 @@
+//
+//  PrismStream.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+#include "PrismStream.h"
+#include <math.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if PRISM_ENABLE_ZSTD
+#   include <zstd.h>
+#endif
+
+template <typename T>  T min( T a, T b){ return a < b ? a : b;}
+template <typename T>  T max( T a, T b){ return a > b ? a : b;}
+
+// 8 x 64 kB blocks in flight between the decompressor and the parser
+static const size_t kBlockSize = 64 * 1024;
+static const unsigned kBlockCount = 8;
+
+// BlockQueue
+
+typedef struct Block
+{
+    size_t  size;
+    char    data[kBlockSize];
+}Block;
+
+/*! @abstract A bounded single producer / single consumer queue of fixed size blocks
+ *  @discussion The queue owns all of its blocks. The producer takes empty blocks, fills them and pushes them. The consumer pops
+ *              full blocks and releases them when done, which makes them available to the producer again. Since there are only
+ *              kBlockCount blocks, a producer that gets ahead of the consumer blocks waiting for one to come back. */
+class BlockQueue
+{
+private:
+    Block                   blocks[kBlockCount];
+    Block *                 empty[kBlockCount];
+    Block *                 full[kBlockCount];
+    unsigned                emptyCount;
+    unsigned                fullHead, fullCount;
+    bool                    finished;       // producer is done. No more full blocks will arrive.
+    bool                    failed;         // producer hit corrupt or truncated data
+    bool                    cancelled;      // consumer is done. Producer should stop.
+    std::mutex              lock;
+    std::condition_variable changed;
+
+public:
+    BlockQueue() : emptyCount(kBlockCount), fullHead(0), fullCount(0), finished(false), failed(false), cancelled(false)
+    {
+        for( unsigned i = 0; i < kBlockCount; i++)
+            empty[i] = &blocks[i];
+    }
+
+    /*! @abstract Producer: get a block to fill. Returns NULL if the consumer has given up. */
+    Block * __nullable AcquireEmpty()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait( guard, [this]{ return emptyCount > 0 || cancelled; });
+        if( cancelled )
+            return NULL;
+
+        Block * result = empty[--emptyCount];
+        result->size = 0;
+        return result;
+    }
+
+    /*! @abstract Producer: hand a filled block to the consumer */
+    void PushFull( Block * __nonnull block )
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        assert( fullCount < kBlockCount);
+        full[ (fullHead + fullCount) % kBlockCount ] = block;
+        fullCount++;
+        changed.notify_all();
+    }
+
+    /*! @abstract Producer: signal end of data
+     *  @param ok  false if the data stopped early because it was corrupt or truncated */
+    void Finish( bool ok )
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        finished = true;
+        failed = ! ok;
+        changed.notify_all();
+    }
+
+    /*! @abstract True if the producer finished with an error. Only meaningful once the producer has finished. */
+    bool Failed()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return failed;
+    }
+
+    /*! @abstract Consumer: get the next full block, or NULL at end of data */
+    Block * __nullable PopFull()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait( guard, [this]{ return fullCount > 0 || finished; });
+        if( 0 == fullCount )
+            return NULL;
+
+        Block * result = full[fullHead];
+        fullHead = (fullHead + 1) % kBlockCount;
+        fullCount--;
+        return result;
+    }
+
+    /*! @abstract Consumer: return a block to the producer */
+    void Release( Block * __nonnull block )
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        assert( emptyCount < kBlockCount);
+        empty[emptyCount++] = block;
+        changed.notify_all();
+    }
+
+    /*! @abstract Consumer: stop the producer early, e.g. on a parse error */
+    void Cancel()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        cancelled = true;
+        changed.notify_all();
+    }
+};
+
+// Decompression
+
+PrismCompression DetectCompression( const void * __nonnull bytes, size_t size )
+{
+    const uint8_t * p = (const uint8_t *) bytes;
+
+    if( size >= 2 && p[0] == 0x1f && p[1] == 0x8b )
+        return PrismCompressionGzip;
+
+    if( size >= 4 && p[0] == 0x28 && p[1] == 0xb5 && p[2] == 0x2f && p[3] == 0xfd )
+        return PrismCompressionZstd;
+
+    // zlib header: deflate method, 32k window or less, and a header checksum that is a multiple of 31
+    if( size >= 2 && (p[0] & 0x0f) == 8 && (p[0] >> 4) <= 7 && 0 == ((p[0] << 8) | p[1]) % 31 )
+        return PrismCompressionGzip;
+
+    return PrismCompressionNone;
+}
+
+static bool ReadUncompressed( int fd, BlockQueue & queue )
+{
+    Block * block;
+    bool ok = true;
+    while( (block = queue.AcquireEmpty()) )
+    {
+        ssize_t bytes;
+        do{
+            bytes = read( fd, block->data, kBlockSize );
+        }while( bytes < 0 && errno == EINTR );
+
+        if( bytes <= 0 )
+        {
+            ok = 0 == bytes;
+            queue.Release(block);
+            break;
+        }
+
+        block->size = bytes;
+        queue.PushFull(block);
+    }
+
+    return ok;
+}
+
+static bool ReadGzip( int fd, BlockQueue & queue )
+{
+    z_stream stream;
+    memset( &stream, 0, sizeof(stream));
+    if( Z_OK != inflateInit2( &stream, 15 + 32 ))   // +32: autodetect gzip or zlib header
+        return false;
+
+    Bytef input[kBlockSize];
+    Block * block = NULL;
+    bool done = false;
+    bool ok = true;
+    while( ! done )
+    {
+        if( 0 == stream.avail_in )
+        {
+            ssize_t bytes;
+            do{
+                bytes = read( fd, input, sizeof(input) );
+            }while( bytes < 0 && errno == EINTR );
+
+            if( bytes <= 0 )
+            {
+                ok = false;         // end of file inside a member
+                break;
+            }
+
+            stream.next_in = input;
+            stream.avail_in = (uInt) bytes;
+        }
+
+        if( NULL == block && NULL == (block = queue.AcquireEmpty()) )
+            break;
+
+        stream.next_out = (Bytef*) block->data + block->size;
+        stream.avail_out = (uInt)(kBlockSize - block->size);
+        int err = inflate( &stream, Z_NO_FLUSH );
+        block->size = kBlockSize - stream.avail_out;
+
+        switch( err )
+        {
+            case Z_OK:
+            case Z_BUF_ERROR:       // no progress possible. Need more input or more output space.
+                break;
+            case Z_STREAM_END:
+            {
+                // gzip files may be a concatenation of several members. Look at the next two bytes for the gzip magic.
+                memmove( input, stream.next_in, stream.avail_in);
+                stream.next_in = input;
+                while( stream.avail_in < 2 )
+                {
+                    ssize_t bytes = read( fd, input + stream.avail_in, sizeof(input) - stream.avail_in);
+                    if( bytes < 0 && errno == EINTR )
+                        continue;
+                    if( bytes < 0 )
+                        ok = false;
+                    if( bytes <= 0 )
+                        break;
+                    stream.avail_in += (uInt) bytes;
+                }
+
+                if( 0 == stream.avail_in || ! ok )
+                    done = true;
+                else if( stream.avail_in >= 2 && 0x1f == input[0] && 0x8b == input[1] )
+                    inflateReset(&stream);
+                else
+                {
+                    // Padding or other junk after the last member. gzip -d ignores it with a warning, so do the same.
+                    fprintf( stderr, "Ignoring trailing data after the compressed stream\n");
+                    done = true;
+                }
+                break;
+            }
+            default:
+                done = true;        // corrupt data
+                ok = false;
+                break;
+        }
+
+        if( block->size == kBlockSize || (done && block->size) )
+        {
+            queue.PushFull(block);
+            block = NULL;
+        }
+    }
+
+    if( block && block->size )
+        queue.PushFull(block);
+    else if( block )
+        queue.Release(block);
+
+    inflateEnd( &stream );
+    return ok;
+}
+
+#if PRISM_ENABLE_ZSTD
+static bool ReadZstd( int fd, BlockQueue & queue )
+{
+    ZSTD_DStream * stream = ZSTD_createDStream();
+    if( NULL == stream )
+        return false;
+
+    char inputBuffer[kBlockSize];
+    ZSTD_inBuffer input = { inputBuffer, 0, 0 };
+    Block * block = NULL;
+    bool outputFull = false;    // last call filled the block, so zstd may still be holding decoded data
+    size_t pending = 0;         // last return value. Nonzero means the frame isn't finished.
+    bool ok = true;
+    while(1)
+    {
+        if( input.pos == input.size && ! outputFull )
+        {
+            ssize_t bytes;
+            do{
+                bytes = read( fd, inputBuffer, sizeof(inputBuffer) );
+            }while( bytes < 0 && errno == EINTR );
+
+            if( bytes <= 0 )
+            {
+                ok = 0 == bytes && 0 == pending;    // nonzero at end of file means the last frame is truncated
+                break;
+            }
+
+            input.size = bytes;
+            input.pos = 0;
+        }
+
+        if( NULL == block && NULL == (block = queue.AcquireEmpty()) )
+            break;
+
+        ZSTD_outBuffer output = { block->data, kBlockSize, block->size };
+        pending = ZSTD_decompressStream( stream, &output, &input );
+        block->size = output.pos;
+        if( ZSTD_isError(pending) )
+        {
+            ok = false;
+            break;
+        }
+        outputFull = output.pos == output.size;
+
+        if( block->size == kBlockSize )
+        {
+            queue.PushFull(block);
+            block = NULL;
+        }
+    }
+
+    if( block && block->size )
+        queue.PushFull(block);
+    else if( block )
+        queue.Release(block);
+
+    ZSTD_freeDStream( stream );
+    return ok;
+}
+#endif
+
+static void Decompress( int fd, PrismCompression compression, BlockQueue & queue )
+{
+    bool ok = false;
+    switch( compression )
+    {
+        case PrismCompressionNone:
+            ok = ReadUncompressed( fd, queue );
+            break;
+        case PrismCompressionGzip:
+            ok = ReadGzip( fd, queue );
+            break;
+#if PRISM_ENABLE_ZSTD
+        case PrismCompressionZstd:
+            ok = ReadZstd( fd, queue );
+            break;
+#endif
+        default:
+            break;
+    }
+
+    queue.Finish( ok );
+}
+
+// Streaming parser
+
+/*! @abstract Presents the blocks coming out of a BlockQueue as a stream of characters */
+class StreamInput
+{
+private:
+    BlockQueue &        queue;
+    Block * __nullable  block;
+    size_t              pos;
+    char *  __nullable  scratch;        // token accumulator for strings and numbers which straddle blocks
+    size_t              scratchSize;
+
+    int Refill()
+    {
+        while(1)
+        {
+            if( block )
+                queue.Release(block);
+
+            block = queue.PopFull();
+            pos = 0;
+            if( NULL == block )
+                return -1;
+
+            if( block->size )
+                return (unsigned char) block->data[0];
+        }
+    }
+
+public:
+    StreamInput( BlockQueue & q ) : queue(q), block(NULL), pos(0), scratch(NULL), scratchSize(0){}
+    ~StreamInput()
+    {
+        if( block )
+            queue.Release(block);
+        free(scratch);
+    }
+
+    /*! @abstract Return the next character without consuming it, or -1 at end of data */
+    inline int Peek()
+    {
+        if( block && pos < block->size )
+            return (unsigned char) block->data[pos];
+        return Refill();
+    }
+
+    /*! @abstract Consume the character returned by Peek(). */
+    inline void Advance(){ pos++; }
+
+    /*! @abstract Make sure the scratch buffer can hold at least size bytes */
+    char * __nullable Scratch( size_t size )
+    {
+        if( size <= scratchSize )
+            return scratch;
+
+        size_t newSize = max( size, scratchSize * 2 );
+        char * p = (char*) realloc( scratch, newSize);
+        if( NULL == p )
+            return NULL;
+
+        scratch = p;
+        scratchSize = newSize;
+        return scratch;
+    }
+};
+
+static FileNode * __nullable StreamParseObject( StreamInput & input );
+
+static FileNodeSet * __nullable StreamParseSet( StreamInput & input )
+{
+    FileNodeSet * set = new FileNodeSet();
+    if( NULL == set)
+        return set;
+
+    int c = input.Peek();
+    if( c < 0 || '}' == c)
+        return set;
+
+    FileNode * object;
+    while((object = StreamParseObject(input)))
+    {
+        set->AppendNode(object);
+        if( input.Peek() != ',')
+            break;
+
+        input.Advance();
+    }
+
+    return set;
+}
+
+static FileNodeArray * __nullable StreamParseArray( StreamInput & input )
+{
+    int c = input.Peek();
+    if( c < 0 )
+        return NULL;
+
+    if( ']' == c)
+        return new FileNodeArray(NULL);
+
+    FileNodeSet * set = StreamParseSet(input);
+    if( NULL == set )
+        return NULL;
+
+    FileNodeArray * result = new FileNodeArray(set);
+    delete set;
+    return result;
+}
+
+static FileNodeString * __nullable StreamParseString( StreamInput & input )
+{
+    if( input.Peek() != '"')
+        return NULL;
+    input.Advance();
+
+    // Same rule as ParseString(): the string ends at the first '"' not preceded by a backslash
+    size_t len = 0;
+    char last = '\0';
+    int c;
+    while( (c = input.Peek()) >= 0 )
+    {
+        if( c == '"' && last != '\\' )
+            break;
+
+        char * buffer = input.Scratch(len + 1);
+        if( NULL == buffer )
+            return NULL;
+
+        buffer[len++] = (char) c;
+        last = (char) c;
+        input.Advance();
+    }
+
+    if( '"' != c )
+        return NULL;
+    input.Advance();
+
+    char * buffer = input.Scratch(len + 1);
+    if( NULL == buffer )
+        return NULL;
+    buffer[len] = '\0';
+
+    return FileNodeString::Create( buffer, len);
+}
+
+static FileNode * __nullable StreamParseNumber( StreamInput & input )
+{
+    // Gather the characters strtod would consume for an ordinary decimal number
+    size_t len = 0;
+    int c;
+    char last = '\0';
+    while( (c = input.Peek()) >= 0 )
+    {
+        bool isNumeric = (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E';
+        if( c == '-' || c == '+' )
+            isNumeric = (0 == len) || last == 'e' || last == 'E';
+        if( ! isNumeric )
+            break;
+
+        char * buffer = input.Scratch(len + 2);
+        if( NULL == buffer )
+            return NULL;
+
+        buffer[len++] = (char) c;
+        last = (char) c;
+        input.Advance();
+    }
+
+    char * buffer = input.Scratch(len + 1);
+    if( NULL == buffer )
+        return NULL;
+    buffer[len] = '\0';
+
+    char * end = buffer;
+    double value = strtod(buffer, &end);     // all int32_ts are exactly representable as doubles
+    if( end == buffer)
+        return NULL;
+
+    if( IsInt32Value(value))
+        return new FileNodeInt( int32_t(value));
+
+    return new FileNodeDouble(value);
+}
+
+static FileNode * __nullable StreamParseBoolean( StreamInput & input )
+{
+    const char * word = 't' == (input.Peek() | 0x20) ? "true" : "false";
+    for( const char * p = word; *p; p++ )
+    {
+        int c = input.Peek();
+        if( c < 0 )
+            break;                      // matches ParseObject(), which accepts a truncated keyword at end of file
+
+        if( (c | 0x20) != *p )
+            return NULL;
+
+        input.Advance();
+    }
+
+    return new FileNodeBoolean( word[0] == 't' );
+}
+
+static FileNode * __nullable StreamParseObject( StreamInput & input )
+{
+    int next = input.Peek();
+    if( next < 0 )
+        return NULL;
+
+    FileNode * __nullable result = NULL;
+    char closeChar = '\0';
+    switch(next)
+    {
+        case '{':   // set
+            input.Advance();
+            result = StreamParseSet( input);
+            closeChar = '}';
+            break;
+        case '[':   // array
+            input.Advance();
+            result = StreamParseArray( input);
+            closeChar = ']';
+            break;
+        case '"':
+            result = StreamParseString(input);
+            if( NULL == result || input.Peek() != ':')
+                break;
+
+            // key value pair
+            {
+                FileNodeString * key = (FileNodeString *) result;
+
+                // skip ':'
+                input.Advance();
+                FileNode * value = input.Peek() >= 0 ? StreamParseObject(input) : NULL;
+                result = new FileNodeKeyValuePair( key, value);
+            }
+            break;
+        default:
+            // A constant of some kind
+            if( next == '.' || next == '-' || (next >= '0' && next <= '9') )
+                result = StreamParseNumber(input);
+            else if( 'f' == (next | 0x20) || 't' == (next | 0x20) )
+                result = StreamParseBoolean(input);
+            // Unlike ParseObject(), don't abort() on garbage. A damaged archive shouldn't take the process down.
+            break;
+    }
+
+    if( '\0' != closeChar)
+    {
+        if( input.Peek() != closeChar)
+        {
+            delete result;
+            return NULL;
+        }
+
+        input.Advance();
+    }
+
+    return result;
+}
+
+FileNode * __nullable ParseCompressedFile( const char * __nonnull path )
+{
+    int fd = open( path, O_RDONLY);
+    if( fd < 0 )
+        return NULL;
+
+    uint8_t magic[4];
+    ssize_t magicSize = pread( fd, magic, sizeof(magic), 0);
+    PrismCompression compression = magicSize > 0 ? DetectCompression( magic, magicSize ) : PrismCompressionNone;
+#if ! PRISM_ENABLE_ZSTD
+    if( PrismCompressionZstd == compression )
+    {
+        fprintf( stderr, "\"%s\" is zstd compressed, but this build lacks PRISM_ENABLE_ZSTD\n", path);
+        close(fd);
+        return NULL;
+    }
+#endif
+
+    BlockQueue * queue = new BlockQueue();
+    std::thread decompressor( Decompress, fd, compression, std::ref(*queue) );
+
+    FileNode * result = NULL;
+    {
+        StreamInput input(*queue);
+        result = StreamParseObject( input );
+
+        // The parser may stop before the end of the data. Let the decompressor go.
+        queue->Cancel();
+    }
+
+    decompressor.join();
+
+    // A tree built from a truncated or corrupt stream may still look complete. Don't hand it back.
+    if( result && queue->Failed() )
+    {
+        fprintf( stderr, "\"%s\" is corrupt or truncated\n", path);
+        delete result;
+        result = NULL;
+    }
+    delete queue;
+    close(fd);
+
+    return result;
+}
+
+// Compressed output
+
+#if PRISM_ENABLE_ZSTD
+typedef struct ZstdWriter
+{
+    ZSTD_CStream *  stream;
+    int             fd;
+    char            buffer[kBlockSize];
+}ZstdWriter;
+
+static bool ZstdFlushOutput( ZstdWriter * writer, ZSTD_outBuffer & output )
+{
+    const char * p = (const char *) output.dst;
+    size_t remaining = output.pos;
+    while( remaining )
+    {
+        ssize_t bytes = write( writer->fd, p, remaining);
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes <= 0 )
+            return false;
+
+        p += bytes;
+        remaining -= bytes;
+    }
+
+    output.pos = 0;
+    return true;
+}
+
+static ssize_t ZstdWrite( void * cookie, const char * buf, size_t size )
+{
+    ZstdWriter * writer = (ZstdWriter *) cookie;
+    ZSTD_inBuffer input = { buf, size, 0 };
+    while( input.pos < input.size )
+    {
+        ZSTD_outBuffer output = { writer->buffer, sizeof(writer->buffer), 0 };
+        size_t err = ZSTD_compressStream2( writer->stream, &output, &input, ZSTD_e_continue );
+        if( ZSTD_isError(err) || ! ZstdFlushOutput( writer, output ) )
+            return -1;
+    }
+
+    return (ssize_t) size;
+}
+
+static int ZstdClose( void * cookie )
+{
+    ZstdWriter * writer = (ZstdWriter *) cookie;
+    int result = 0;
+    ZSTD_inBuffer input = { NULL, 0, 0 };
+    size_t remaining;
+    do
+    {
+        ZSTD_outBuffer output = { writer->buffer, sizeof(writer->buffer), 0 };
+        remaining = ZSTD_compressStream2( writer->stream, &output, &input, ZSTD_e_end );
+        if( ZSTD_isError(remaining) || ! ZstdFlushOutput( writer, output ) )
+        {
+            result = -1;
+            break;
+        }
+    }while( remaining );
+
+    ZSTD_freeCStream( writer->stream );
+    if( close( writer->fd ) )
+        result = -1;
+    free( writer );
+    return result;
+}
+#endif
+
+static ssize_t GzipWrite( void * cookie, const char * buf, size_t size )
+{
+    if( 0 == size )
+        return 0;
+
+    int bytes = gzwrite( (gzFile) cookie, buf, (unsigned) size );
+    return bytes > 0 ? bytes : -1;
+}
+
+static int GzipClose( void * cookie )
+{
+    return Z_OK == gzclose( (gzFile) cookie ) ? 0 : -1;
+}
+
+#if defined( __APPLE__ ) || defined( __FreeBSD__ )
+// funopen() wants int sized write functions. Casting a size_t one to fit is undefined: on arm64 the upper half of the
+// length register is garbage. Route calls through int typed trampolines instead.
+typedef struct WriteCookie
+{
+    void *      cookie;
+    ssize_t     (*writeFunc)(void *, const char *, size_t);
+    int         (*closeFunc)(void *);
+}WriteCookie;
+
+static int WriteCookieWrite( void * cookie, const char * buf, int size )
+{
+    WriteCookie * c = (WriteCookie *) cookie;
+    if( size < 0 )
+        return -1;
+    return (int) c->writeFunc( c->cookie, buf, (size_t) size );
+}
+
+static int WriteCookieClose( void * cookie )
+{
+    WriteCookie * c = (WriteCookie *) cookie;
+    int result = c->closeFunc ? c->closeFunc( c->cookie ) : 0;
+    free( c );
+    return result;
+}
+#endif
+
+FILE * __nullable OpenWriteCookie( void * __nonnull cookie, ssize_t (* __nonnull writeFunc)(void *, const char *, size_t), int (* __nullable closeFunc)(void *) )
+{
+#if defined( __APPLE__ ) || defined( __FreeBSD__ )
+    WriteCookie * c = (WriteCookie *) malloc( sizeof(WriteCookie));
+    if( NULL == c )
+        return NULL;
+    c->cookie = cookie;
+    c->writeFunc = writeFunc;
+    c->closeFunc = closeFunc;
+
+    FILE * result = funopen( c, NULL, WriteCookieWrite, NULL, WriteCookieClose );
+    if( NULL == result )
+        free( c );
+    return result;
+#else
+    cookie_io_functions_t functions = { NULL, writeFunc, NULL, closeFunc };
+    return fopencookie( cookie, "w", functions );
+#endif
+}
+
+FILE * __nullable OpenCompressedFile( const char * __nonnull path, PrismCompression compression, int level )
+{
+    FILE * result = NULL;
+    switch( compression )
+    {
+        case PrismCompressionNone:
+            return fopen( path, "w" );
+
+        case PrismCompressionGzip:
+        {
+            char mode[8];
+            if( level > 0 )
+                snprintf( mode, sizeof(mode), "wb%d", min(level, 9));
+            else
+                snprintf( mode, sizeof(mode), "wb");
+
+            gzFile file = gzopen( path, mode );
+            if( NULL == file )
+                return NULL;
+
+            gzbuffer( file, kBlockSize );
+            result = OpenWriteCookie( file, GzipWrite, GzipClose );
+            if( NULL == result )
+                gzclose( file );
+            break;
+        }
+
+#if PRISM_ENABLE_ZSTD
+        case PrismCompressionZstd:
+        {
+            ZstdWriter * writer = (ZstdWriter *) calloc( 1, sizeof(ZstdWriter));
+            if( NULL == writer )
+                return NULL;
+
+            writer->fd = open( path, O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+            writer->stream = ZSTD_createCStream();
+            if( writer->fd < 0 || NULL == writer->stream )
+            {
+                if( writer->fd >= 0 )
+                    close( writer->fd );
+                ZSTD_freeCStream( writer->stream );
+                free( writer );
+                return NULL;
+            }
+
+            if( level > 0 )
+                ZSTD_CCtx_setParameter( writer->stream, ZSTD_c_compressionLevel, level );
+
+            result = OpenWriteCookie( writer, ZstdWrite, ZstdClose );
+            if( NULL == result )
+                ZstdClose( writer );
+            break;
+        }
+#endif
+
+        default:
+            return NULL;
+    }
+
+    // FileNode::write() makes lots of tiny writes. Batch them up before they reach the compressor.
+    if( result )
+        setvbuf( result, NULL, _IOFBF, kBlockSize );
+
+    return result;
+}
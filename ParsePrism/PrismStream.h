@@ -0,0 +1,67 @@
+//
+//  PrismStream.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+#ifndef PrismStream_h
+#define PrismStream_h
+
+#include "FileNode.h"
+#include <sys/types.h>
+
+// zstd isn't part of the macOS SDK. Define PRISM_ENABLE_ZSTD=1 and link libzstd to read and write .zst files.
+#ifndef PRISM_ENABLE_ZSTD
+#   define PRISM_ENABLE_ZSTD   0
+#endif
+
+/*! @abstract Compression formats understood by the streaming reader and writer */
+typedef enum PrismCompression : int8_t
+{
+    PrismCompressionInvalid = -1,
+    PrismCompressionNone = 0,
+    PrismCompressionGzip,           // gzip or zlib wrapper around deflate
+    PrismCompressionZstd
+}PrismCompression;
+
+/*! @abstract Guess the compression format from the first few bytes of a file */
+PrismCompression DetectCompression( const void * __nonnull bytes, size_t size );
+
+/*! @abstract  Read a (possibly compressed) file from disk and create a tree of nodes
+ *  @discussion Decompression runs on its own thread and feeds fixed size blocks through a bounded queue to a streaming
+ *              parser on the calling thread, so the two overlap and the decompressed file is never resident all at once.
+ *              The compression format is detected from the file contents. */
+FileNode * __nullable ParseCompressedFile( const char * __nonnull path );
+
+/*! @abstract  Create a file which compresses everything written to it
+ *  @discussion Pass the result to FileNode::write() and fclose() it when done. PrismCompressionNone gives a plain file.
+ *  @param level  Compression level, or 0 for the library default */
+FILE * __nullable OpenCompressedFile( const char * __nonnull path, PrismCompression compression, int level );
+
+/*! @abstract  Create a FILE which hands everything written to it to writeFunc, and calls closeFunc from fclose()
+ *  @discussion A portable face for funopen() (Apple, BSD) and fopencookie() (glibc). writeFunc returns bytes consumed or -1. */
+FILE * __nullable OpenWriteCookie( void * __nonnull cookie, ssize_t (* __nonnull writeFunc)(void *, const char *, size_t), int (* __nullable closeFunc)(void *) );
+
+#endif /* PrismStream_h */
@@ -0,0 +1,73 @@
+//
+//  PrismThreads.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismThreads_h
+#define PrismThreads_h
+
+#include <thread>
+#include <vector>
+
+/*! @abstract The number of threads to use when the caller doesn't say */
+static inline unsigned DefaultThreadCount()
+{
+    unsigned count = std::thread::hardware_concurrency();
+    return count ? count : 1;
+}
+
+/*! @abstract Split [0, count) into threadCount contiguous ranges and call body( begin, end, rangeIndex ) on each in parallel
+ *  @discussion Ranges are in order, so rangeIndex can be used to find per-thread results afterward. The calling thread does the
+ *              first range itself and returns once all have finished. */
+template <typename Body>
+static inline void ParallelFor( unsigned long count, unsigned threadCount, const Body & body )
+{
+    if( 0 == threadCount )
+        threadCount = DefaultThreadCount();
+    if( threadCount > count )
+        threadCount = count ? (unsigned) count : 1;
+
+    unsigned long step = count / threadCount;
+    unsigned long extra = count % threadCount;
+    std::vector<std::thread> threads;
+    threads.reserve( threadCount );
+
+    unsigned long begin = step + (extra ? 1 : 0);
+    for( unsigned i = 1; i < threadCount; i++)
+    {
+        unsigned long end = begin + step + (i < extra ? 1 : 0);
+        threads.emplace_back( [&body, begin, end, i]{ body( begin, end, i); });
+        begin = end;
+    }
+
+    body( 0UL, step + (extra ? 1 : 0), 0U);
+
+    for( std::thread & t : threads )
+        t.join();
+}
+
+#endif /* PrismThreads_h */
@@ -0,0 +1,378 @@
+//
+//  PrismWriter.cpp
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#include "PrismWriter.h"
+#include "PrismStream.h"
+#include "PrismThreads.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <mutex>
+#include <condition_variable>
+
+template <typename T>  T min( T a, T b){ return a < b ? a : b;}
+template <typename T>  T max( T a, T b){ return a > b ? a : b;}
+
+#ifndef IOV_MAX
+#   define IOV_MAX  1024
+#endif
+
+// How far ahead of the disk the serializers may get, in runs per thread
+static const unsigned kRunsInFlight = 4;
+
+typedef enum PieceType : int8_t
+{
+    PieceTypeNode = 0,          // node->write()
+    PieceTypeLiteral,           // punctuation
+    PieceTypeKey                // the key of a key-value pair and its ':'
+}PieceType;
+
+/*! @abstract A piece of the output */
+typedef struct Piece
+{
+    PieceType                   type;
+    const FileNode * __nullable node;
+    const char * __nullable     literal;
+}Piece;
+
+// Unroll the top depth levels of sets and arrays into pieces. Everything below is left to write().
+static void Flatten( const FileNode * __nullable node, unsigned depth, std::vector<Piece> & pieces )
+{
+    if( NULL == node )
+        return;
+    
+    switch( node->GetType() )
+    {
+        case NodeTypeKeyValuePair:
+        {
+            // same as FileNodeKeyValuePair::write()
+            const FileNodeKeyValuePair * pair = (const FileNodeKeyValuePair *) node;
+            pieces.push_back( { PieceTypeKey, node, NULL });
+            if( NULL == pair->GetValue() )
+                pieces.push_back( { PieceTypeLiteral, NULL, "{}" });
+            else
+                Flatten( pair->GetValue(), depth, pieces);
+            return;
+        }
+        case NodeTypeSet:
+            if( 0 == depth )
+                break;
+            
+            // same as FileNodeSet::write()
+            pieces.push_back( { PieceTypeLiteral, NULL, "{" });
+            for( const FileNode * child = ((const FileNodeSet *) node)->GetSet(); child; child = child->GetNext() )
+            {
+                if( child != ((const FileNodeSet *) node)->GetSet() )
+                    pieces.push_back( { PieceTypeLiteral, NULL, "," });
+                Flatten( child, depth - 1, pieces);
+            }
+            pieces.push_back( { PieceTypeLiteral, NULL, "}" });
+            return;
+        case NodeTypeArray:
+        {
+            if( 0 == depth )
+                break;
+            
+            // same as FileNodeArray::write()
+            const FileNodeArray & array = *(const FileNodeArray *) node;
+            pieces.push_back( { PieceTypeLiteral, NULL, "[" });
+            for( unsigned long i = 0; i < array.GetCount(); i++ )
+            {
+                if( i != 0 )
+                    pieces.push_back( { PieceTypeLiteral, NULL, "," });
+                Flatten( array[(int) i], depth - 1, pieces);
+            }
+            pieces.push_back( { PieceTypeLiteral, NULL, "]" });
+            return;
+        }
+        default:
+            break;
+    }
+    
+    pieces.push_back( { PieceTypeNode, node, NULL });
+}
+
+static unsigned long CountNodes( const std::vector<Piece> & pieces )
+{
+    unsigned long count = 0;
+    for( const Piece & piece : pieces )
+        count += PieceTypeNode == piece.type;
+    return count;
+}
+
+/*! @abstract A growable output buffer. These are recycled from run to run so their pages stay warm. */
+typedef struct Buffer
+{
+    char * __nullable   data;
+    size_t              size;
+    size_t              capacity;
+}Buffer;
+
+static ssize_t BufferWrite( void * cookie, const char * bytes, size_t count )
+{
+    Buffer * buffer = (Buffer *) cookie;
+    if( buffer->size + count > buffer->capacity )
+    {
+        size_t capacity = max( buffer->capacity * 2, buffer->size + count);
+        char * data = (char *) realloc( buffer->data, capacity);
+        if( NULL == data )
+            return -1;
+        
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    
+    memcpy( buffer->data + buffer->size, bytes, count);
+    buffer->size += count;
+    return (ssize_t) count;
+}
+
+typedef struct Run
+{
+    unsigned long       first, end;     // pieces
+    Buffer * __nullable buffer;
+    bool                done;
+}Run;
+
+static bool WriteAll( int fd, struct iovec * __nonnull iov, int count )
+{
+    while( count > 0 )
+    {
+        ssize_t bytes = writev( fd, iov, count);
+        if( bytes < 0 && errno == EINTR )
+            continue;
+        if( bytes < 0 )
+            return false;
+        
+        // skip what was written, which may end partway through a buffer
+        while( count > 0 && (size_t) bytes >= iov->iov_len )
+        {
+            bytes -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if( count > 0 )
+        {
+            iov->iov_base = (char *) iov->iov_base + bytes;
+            iov->iov_len -= bytes;
+        }
+    }
+    
+    return true;
+}
+
+// Plain root->write() to fd, for when there is nothing to run in parallel
+static bool SerialWrite( const FileNode * __nonnull root, int fd )
+{
+    int copy = dup( fd);        // so fclose() leaves the caller's fd open
+    FILE * file = copy >= 0 ? fdopen( copy, "w") : NULL;
+    if( NULL == file )
+    {
+        if( copy >= 0 )
+            close( copy);
+        return false;
+    }
+    
+    setvbuf( file, NULL, _IOFBF, 64 * 1024);
+    root->write( file);
+    bool ok = ! ferror( file);
+    return 0 == fclose( file) && ok;
+}
+
+bool ParallelWrite( const FileNode * __nonnull root, int fd, unsigned threadCount )
+{
+    if( 0 == threadCount )
+        threadCount = DefaultThreadCount();
+    
+    // Splitting the tree up and copying through buffers only pays off when there is someone to share the work with
+    if( threadCount <= 1 )
+        return SerialWrite( root, fd);
+    
+    // Unroll until there are plenty of nodes to go around, or unrolling stops helping
+    std::vector<Piece> pieces;
+    unsigned long nodeCount = 0;
+    for( unsigned depth = 1; depth <= 8; depth++ )
+    {
+        std::vector<Piece> deeper;
+        Flatten( root, depth, deeper);
+        unsigned long deeperCount = CountNodes( deeper);
+        if( depth > 1 && deeperCount <= nodeCount )
+            break;
+        
+        pieces.swap( deeper);
+        nodeCount = deeperCount;
+        if( nodeCount >= threadCount * 64UL )
+            break;
+    }
+    
+    // Cut the pieces into runs with about the same number of nodes
+    unsigned long runCount = min( max( nodeCount, 1UL), threadCount * 64UL);
+    unsigned long nodesPerRun = (nodeCount + runCount - 1) / runCount;
+    std::vector<Run> runs;
+    Run run = { 0, 0, NULL, false };
+    unsigned long nodesInRun = 0;
+    for( unsigned long i = 0; i < pieces.size(); i++ )
+    {
+        if( PieceTypeNode == pieces[i].type && nodesInRun == nodesPerRun )
+        {
+            run.end = i;
+            runs.push_back( run);
+            run.first = i;
+            nodesInRun = 0;
+        }
+        nodesInRun += PieceTypeNode == pieces[i].type;
+    }
+    run.end = pieces.size();
+    runs.push_back( run);
+    
+    if( runs.size() < 2 )
+        return SerialWrite( root, fd);
+    
+    std::mutex lock;
+    std::condition_variable changed;
+    unsigned long nextRun = 0;          // next to serialize
+    unsigned long writtenRuns = 0;      // runs already handed to the OS
+    bool failed = false;
+    const unsigned long window = threadCount * kRunsInFlight;
+    std::vector<Buffer *> freeBuffers;
+    
+    auto serialize = [&]( unsigned long, unsigned long, unsigned )
+    {
+        while( 1 )
+        {
+            unsigned long index;
+            Buffer * buffer = NULL;
+            {
+                std::unique_lock<std::mutex> guard( lock);
+                changed.wait( guard, [&]{ return failed || nextRun >= runs.size() || nextRun < writtenRuns + window; });
+                if( failed || nextRun >= runs.size() )
+                    return;
+                index = nextRun++;
+                
+                if( freeBuffers.size() )
+                {
+                    buffer = freeBuffers.back();
+                    freeBuffers.pop_back();
+                }
+            }
+            if( NULL == buffer )
+                buffer = (Buffer *) calloc( 1, sizeof(Buffer));
+            
+            Run & r = runs[index];
+            FILE * file = buffer ? OpenWriteCookie( buffer, BufferWrite, NULL) : NULL;
+            bool ok = NULL != file;
+            if( ok )
+            {
+                // write() makes lots of small writes. Let stdio gather them up.
+                setvbuf( file, NULL, _IOFBF, 64 * 1024);
+                for( unsigned long i = r.first; i < r.end; i++ )
+                {
+                    const Piece & piece = pieces[i];
+                    switch( piece.type )
+                    {
+                        case PieceTypeNode:
+                            piece.node->write( file);
+                            break;
+                        case PieceTypeLiteral:
+                            fputs( piece.literal, file);
+                            break;
+                        case PieceTypeKey:
+                            // same as FileNodeKeyValuePair::write()
+                            fputc( '"', file);
+                            fputs( ((const FileNodeKeyValuePair *) piece.node)->GetKey(), file);
+                            fputs( "\":", file);
+                            break;
+                    }
+                }
+                ok = 0 == fclose( file);
+            }
+            
+            std::lock_guard<std::mutex> guard( lock);
+            r.buffer = buffer;
+            r.done = true;
+            if( ! ok )
+                failed = true;
+            changed.notify_all();
+        }
+    };
+    
+    std::thread workers( [&]{ ParallelFor( threadCount, threadCount, serialize); });
+    
+    // Write finished runs in order, as many at a time as are ready
+    struct iovec iov[ IOV_MAX ];
+    while( writtenRuns < runs.size() )
+    {
+        unsigned long ready;
+        {
+            std::unique_lock<std::mutex> guard( lock);
+            changed.wait( guard, [&]{ return failed || runs[writtenRuns].done; });
+            if( failed )
+                break;
+            
+            ready = writtenRuns;
+            while( ready < runs.size() && runs[ready].done && ready - writtenRuns < IOV_MAX )
+                ready++;
+        }
+        
+        int count = 0;
+        for( unsigned long i = writtenRuns; i < ready; i++ )
+            if( runs[i].buffer && runs[i].buffer->size )
+                iov[count++] = { runs[i].buffer->data, runs[i].buffer->size };
+        
+        bool ok = WriteAll( fd, iov, count);
+        
+        std::lock_guard<std::mutex> guard( lock);
+        for( unsigned long i = writtenRuns; i < ready; i++ )
+            if( runs[i].buffer )
+            {
+                runs[i].buffer->size = 0;
+                freeBuffers.push_back( runs[i].buffer);
+                runs[i].buffer = NULL;
+            }
+        writtenRuns = ready;
+        if( ! ok )
+            failed = true;
+        changed.notify_all();
+    }
+    
+    workers.join();
+    
+    for( Run & r : runs )
+        if( r.buffer )
+            freeBuffers.push_back( r.buffer);
+    for( Buffer * buffer : freeBuffers )
+    {
+        free( buffer->data);
+        free( buffer);
+    }
+    
+    return ! failed;
+}
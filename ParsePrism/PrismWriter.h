@@ -0,0 +1,44 @@
+//
+//  PrismWriter.h
+//  ParsePrism
+//
+//  Created by agent on 10/18/26.
+//
+//
+// MIT license:
+//
+// Copyright 2026, agent
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy,
+// modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// This software does not contain code by Samuel Harmon or PrismScroll, nor is it endorsed or maintained by him in any way. This work
+// contains no copyrighted material belonging to Wizards of the Coast(TM) or Hasbro(TM).
+//
+
+
+
+#ifndef PrismWriter_h
+#define PrismWriter_h
+
+#include "FileNode.h"
+
+/*! @abstract  Write out tree to disk using several threads
+ *  @discussion The top levels of the tree are split into runs of nodes. Worker threads serialize runs into their own memory buffers
+ *              with FileNode::write(), while the calling thread writes finished buffers to fd in order with writev(). Only a
+ *              few buffers per thread are held at once. The output is byte for byte the same as root->write().
+ *              With one thread, or a tree too small to split, it just calls root->write().
+ *  @param threadCount  Number of serializing threads, or 0 for one per core
+ *  @return     false if a write failed or memory ran out */
+bool ParallelWrite( const FileNode * __nonnull root, int fd, unsigned threadCount = 0 );
+
+#endif /* PrismWriter_h */
@@ -27,6 +27,11 @@
 
 #include <iostream>
 #include "FileNode.h"
+#include "PrismStream.h"
+#include "PrismSchema.h"
+#include "PrismWriter.h"
+#include "PrismServer.h"
+#include "PrismClient.h"
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -62,6 +67,32 @@ const char * __nullable ReadFile( const char * __nonnull fileName, size_t * __no
 
 int main(int argc, const char * argv[])
 {
+    // ParsePrism -serve ... and ParsePrism -bench ... run the query server and its load generator
+    if( argc > 1 && 0 == strcmp( argv[1], "-serve") )
+        return PrismServerMain( argc, argv);
+    if( argc > 1 && 0 == strcmp( argv[1], "-bench") )
+        return PrismLoadGeneratorMain( argc, argv);
+    
+    // ParsePrism [-schema] [-o out.prism] file.prism
+    bool printSchema = false;
+    const char * outPath = NULL;
+    while( argc > 2 )
+    {
+        if( 0 == strcmp( argv[1], "-schema") )
+            printSchema = true;
+        else if( 0 == strcmp( argv[1], "-o") && argc > 3 )
+        {
+            outPath = argv[2];
+            argv++;
+            argc--;
+        }
+        else
+            break;
+        
+        argv++;
+        argc--;
+    }
+    
     if( argc < 2)
         return -1;
     
@@ -70,9 +101,34 @@ int main(int argc, const char * argv[])
     if( NULL == fileData)
         return -1;
     
-    FileNode * node = FileNode::ParseFile( fileData, fileSize);
+    FileNode * node = NULL;
+    if( PrismCompressionNone == DetectCompression( fileData, fileSize))
+        node = FileNode::ParseFile( fileData, fileSize);
+    else
+    {
+        // compressed archive. Decompress and parse in parallel rather than expanding it in memory first.
+        munmap( (void*) fileData, fileSize);
+        fileData = NULL;
+        node = ParseCompressedFile( argv[1] );
+    }
     
-    if(node)
+    if( node && outPath )
+    {
+        int fd = open( outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if( fd < 0 || ! ParallelWrite( node, fd) )
+            printf( "Write of \"%s\" failed\n", outPath);
+        if( fd >= 0 )
+            close(fd);
+    }
+    else if( node && printSchema )
+    {
+        PrismSchema schema;
+        schema.Infer( node);
+        schema.Print();
+        printf( "\n");
+        schema.PrintBinding( "Item");
+    }
+    else if(node)
         node->Print(0);
     else
         printf( "NULL result\n");
@@ -123,7 +179,8 @@ int main(int argc, const char * argv[])
 //        close(fd);
 //    }
  
-    munmap( (void*) fileData, fileSize);
+    if( fileData )
+        munmap( (void*) fileData, fileSize);
     delete node;
     
     return 0;